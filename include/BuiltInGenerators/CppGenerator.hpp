@@ -3,13 +3,20 @@
 #include <ProgramStructure.hpp>
 #include <Generator.hpp>
 
+struct CompiledTemplate;
+
 class CppGenerator : public Generator
 {
 	std::vector<Generator *> generators;
 	std::string include_prefix = "";
 	bool use_angle_brackets = false; // false for quotes "", true for angle brackets <>
+	unsigned jobs = 0;				 // threads rendering structs and enums, 0 = one per core (-cppJobs)
+
+	bool generate_base_class_header_file(Generator *gen, ProgramStructure *ps, std::string out_path, OutputSink &sink);
 
-	bool generate_base_class_header_file(Generator *gen, ProgramStructure *ps, std::string out_path);
+	// render the templates for one struct / enum, called for several at once
+	bool generate_struct_files(ProgramStructure &ps, StructDefinition &s, const std::vector<StructDefinition> &base_classes, const std::vector<CompiledTemplate> &templates, OutputSink &sink);
+	bool generate_enum_files(EnumDefinition &e, const std::vector<CompiledTemplate> &templates, OutputSink &sink);
 
 public:
 	CppGenerator();
@@ -25,11 +32,12 @@ public:
 
 	bool add_generator_specific_content_to_struct(Generator *gen, ProgramStructure *ps, StructDefinition &s);
 
-	bool generate_files(ProgramStructure ps, std::string out_path);
+	bool generate_files(ProgramStructure &ps, std::string out_path, OutputSink &sink);
 
 	// Methods to configure include behavior
 	void set_include_prefix(const std::string& prefix) { include_prefix = prefix; }
 	void set_use_angle_brackets(bool use_angle) { use_angle_brackets = use_angle; }
+	void set_jobs(unsigned count) { jobs = count; }
 	std::string get_include_prefix() const { return include_prefix; }
 	bool get_use_angle_brackets() const { return use_angle_brackets; }
 };
\ No newline at end of file
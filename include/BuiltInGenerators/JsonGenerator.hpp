@@ -21,5 +21,5 @@ public:
 
 	bool add_generator_specific_content_to_struct(Generator *gen, ProgramStructure *ps, StructDefinition &s);
 
-	bool generate_files(ProgramStructure ps, std::string out_path);
+	bool generate_files(ProgramStructure &ps, std::string out_path, OutputSink &sink);
 };
\ No newline at end of file
@@ -32,9 +32,9 @@ public:
 	std::string generate_lua_serialization_functions(ProgramStructure *ps, StructDefinition &s);
 
 	// File generation functions
-	bool generate_struct_lua_file(ProgramStructure *ps, StructDefinition &s, std::string out_path, std::vector<StructDefinition> base_classes);
-	bool generate_enum_lua_file(EnumDefinition &e, std::string out_path);
-	bool generate_main_lua_file(ProgramStructure &ps, std::string out_path);
+	bool generate_struct_lua_file(ProgramStructure *ps, StructDefinition &s, std::string out_path, OutputSink &sink, std::vector<StructDefinition> base_classes);
+	bool generate_enum_lua_file(EnumDefinition &e, std::string out_path, OutputSink &sink);
+	bool generate_main_lua_file(ProgramStructure &ps, std::string out_path, OutputSink &sink);
 
 	// Utility functions
 	std::string escape_lua_string(std::string str);
@@ -44,15 +44,15 @@ public:
 	// Override functions from Generator base class
 	std::string convert_to_local_type(ProgramStructure *ps, TypeDefinition type) override;
 	bool add_generator_specific_content_to_struct(Generator *gen, ProgramStructure *ps, StructDefinition &s) override;
-	bool generate_files(ProgramStructure ps, std::string out_path) override;
+	bool generate_files(ProgramStructure &ps, std::string out_path, OutputSink &sink) override;
 
 private:
 	// Helper functions for generating Lua code
-	void generate_lua_field(ProgramStructure *ps, MemberVariableDefinition &mv, std::ofstream &luaFile, int indent = 1);
-	void generate_lua_constructor(ProgramStructure *ps, StructDefinition &s, std::ofstream &luaFile);
-	void generate_lua_tostring(ProgramStructure *ps, StructDefinition &s, std::ofstream &luaFile);
-	void generate_lua_validate(ProgramStructure *ps, StructDefinition &s, std::ofstream &luaFile);
-	void generate_generator_methods(ProgramStructure *ps, StructDefinition &s, std::vector<StructDefinition> &base_classes, std::ofstream &luaFile);
+	void generate_lua_field(ProgramStructure *ps, MemberVariableDefinition &mv, std::ostream &luaFile, int indent = 1);
+	void generate_lua_constructor(ProgramStructure *ps, StructDefinition &s, std::ostream &luaFile);
+	void generate_lua_tostring(ProgramStructure *ps, StructDefinition &s, std::ostream &luaFile);
+	void generate_lua_validate(ProgramStructure *ps, StructDefinition &s, std::ostream &luaFile);
+	void generate_generator_methods(ProgramStructure *ps, StructDefinition &s, std::vector<StructDefinition> &base_classes, std::ostream &luaFile);
 	std::string get_lua_default_value(ProgramStructure *ps, TypeDefinition type);
 	std::string indent_string(int level);
 };
@@ -39,10 +39,10 @@ public:
 	void generate_delete_statement_function_struct(Generator *gen, ProgramStructure *ps, StructDefinition &s);
 
 	// File generation functions
-	bool generate_create_table_file(ProgramStructure *ps, StructDefinition &s, std::string out_path);
-	bool generate_select_all_files(ProgramStructure *ps, StructDefinition &s, std::string out_path);
-	bool generate_select_files(ProgramStructure *ps, StructDefinition &s, std::string out_path);
-	bool generate_struct_files(ProgramStructure *ps, StructDefinition &s, std::string out_path);
+	bool generate_create_table_file(ProgramStructure *ps, StructDefinition &s, std::string out_path, OutputSink &sink);
+	bool generate_select_all_files(ProgramStructure *ps, StructDefinition &s, std::string out_path, OutputSink &sink);
+	bool generate_select_files(ProgramStructure *ps, StructDefinition &s, std::string out_path, OutputSink &sink);
+	bool generate_struct_files(ProgramStructure *ps, StructDefinition &s, std::string out_path, OutputSink &sink);
 
 	// Utility functions
 	std::string escape_string(std::string str);
@@ -50,12 +50,12 @@ public:
 	bool is_mysql_keyword(const std::string& word);
 
 	// Function to add foreign key columns for array relationships
-	void add_foreign_key_columns_for_arrays(ProgramStructure *ps);
+	void add_foreign_key_columns_for_arrays(ProgramStructure *ps, ModelOverlay &overlay);
 
 	// Override functions from Generator base class
 	std::string convert_to_local_type(ProgramStructure *ps, TypeDefinition type) override;
 	bool add_generator_specific_content_to_struct(Generator *gen, ProgramStructure *ps, StructDefinition &s) override;
-	bool generate_files(ProgramStructure ps, std::string out_path) override;
+	bool generate_files(ProgramStructure &ps, std::string out_path, OutputSink &sink) override;
 
 	void set_generate_select_all_files(bool value) { gen_select_all_files = value; }
 	void set_generate_select_files(bool value) { gen_select_files = value; }
@@ -45,18 +45,18 @@ class SqliteGenerator : public Generator
 	void generate_delete_statement_function_struct(Generator *gen, ProgramStructure *ps, StructDefinition &s);
 
 	// file generation functions
-	bool generate_create_table_file(ProgramStructure *ps, StructDefinition &s, std::string out_path);
+	bool generate_create_table_file(ProgramStructure *ps, StructDefinition &s, std::string out_path, OutputSink &sink);
 
-	bool generate_select_all_files(ProgramStructure *ps, StructDefinition &s, std::string out_path);
+	bool generate_select_all_files(ProgramStructure *ps, StructDefinition &s, std::string out_path, OutputSink &sink);
 
-	bool generate_select_files(ProgramStructure *ps, StructDefinition &s, std::string out_path);
+	bool generate_select_files(ProgramStructure *ps, StructDefinition &s, std::string out_path, OutputSink &sink);
 
-	bool generate_struct_files(ProgramStructure *ps, StructDefinition &s, std::string out_path);
+	bool generate_struct_files(ProgramStructure *ps, StructDefinition &s, std::string out_path, OutputSink &sink);
 
 	std::string escape_string(std::string str);
 
 	// Function to add foreign key columns for array relationships
-	void add_foreign_key_columns_for_arrays(ProgramStructure *ps);
+	void add_foreign_key_columns_for_arrays(ProgramStructure *ps, ModelOverlay &overlay);
 
 public:
 	SqliteGenerator();
@@ -65,5 +65,5 @@ public:
 
 	bool add_generator_specific_content_to_struct(Generator *gen, ProgramStructure *ps, StructDefinition &s);
 
-	bool generate_files(ProgramStructure ps, std::string out_path);
+	bool generate_files(ProgramStructure &ps, std::string out_path, OutputSink &sink);
 };
\ No newline at end of file
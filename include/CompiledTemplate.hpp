@@ -0,0 +1,23 @@
+#pragma once
+#include <OutputSink.hpp>
+#include <inja/inja.hpp>
+#include <string>
+#include <vector>
+
+// An embedded template parsed once per run, together with the pattern of the
+// path it renders to. Rendering only reads the parsed form, so several threads
+// can render the same template, each with its own environment.
+struct CompiledTemplate
+{
+	std::string name; // file name of the template, e.g. {{struct}}Schema.hpp
+	inja::Template path;
+	inja::Template content;
+};
+
+// parses the templates in an embedded directory in file name order, env has
+// to be configured (trim blocks etc.) the way the templates expect
+bool compileTemplates(inja::Environment &env, const std::string &directory, const std::string &out_path, std::vector<CompiledTemplate> &templates);
+
+// renders every template with data into the file its path renders to and
+// hands the files to sink, throws if a template fails to render
+void renderTemplates(inja::Environment &env, const std::vector<CompiledTemplate> &templates, const inja::json &data, OutputSink &sink);
@@ -1,6 +1,7 @@
 #pragma once
 #include <Generator.hpp>
 #include <ArgParser/ArgParser.hpp>
+#include <TemplateCache.hpp>
 #include <string>
 #include <vector>
 
@@ -22,6 +23,9 @@ struct ParameterInfo {
 // Example interface for dynamic generators
 // Dynamic generator libraries should implement this interface
 // and export the required functions
+// Generated files go to the OutputSink passed to Generator::generate_files
+// (GeneratedFile is header only), which resolves into the host like the
+// template cache below
 
 extern "C" {
     // This function should be exported by dynamic generator libraries
@@ -34,6 +38,11 @@ extern "C" {
     // Optional: called to register flags and parameters with the argument parser
     // This allows dynamic generators to add their own command-line options
     void registerArguments(argumentParser* parser);
+
+    // Optional: receives the host's embedded template cache, which stays valid
+    // for the whole run. Use it instead of TemplateCache::instance(), which
+    // is not exported to libraries
+    void setTemplateCache(TemplateCache* cache);
 }
 
 // Example implementation (this would be in a separate .cpp file for the dynamic library):
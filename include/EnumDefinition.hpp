@@ -18,7 +18,7 @@ struct EnumDefinition
 	std::set<std::string> disabled_for_generators;
 
 	void add_value(std::string identifier, int value);
-	void update(EnumDefinition def);
+	void update(const EnumDefinition &def);
 
 	void clear();
 };
\ No newline at end of file
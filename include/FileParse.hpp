@@ -0,0 +1,40 @@
+#pragma once
+#include <StructDefinition.hpp>
+#include <EnumDefinition.hpp>
+#include <Token.hpp>
+#include <string>
+#include <vector>
+
+// One file parsed in isolation by ProgramStructure::readFiles. Its top level
+// statements are kept in source order so the merge can replay them exactly
+// like readFile, and the names it declares are kept for the other files.
+struct FileParse
+{
+	enum ItemKind
+	{
+		INCLUDE,
+		STRUCT,
+		ENUM
+	};
+	struct Item
+	{
+		ItemKind kind;
+		size_t index; // into includes, structs or enums
+	};
+	struct Include
+	{
+		std::string path;
+		bool absolute;
+		Token token;
+	};
+	std::vector<Item> items;
+	std::vector<Include> includes;
+	std::vector<StructDefinition> structs;
+	std::vector<EnumDefinition> enums;
+
+	// struct and enum names found by parseTypeNames, and the struct names alone
+	std::vector<std::string> type_names;
+	std::vector<std::string> struct_names;
+	// every path that follows an 'include' token, resolved against the file
+	std::vector<std::string> include_candidates;
+};
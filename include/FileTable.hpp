@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using FileId = uint32_t;
+
+// Process wide table of source file paths. Tokens and positions carry a
+// FileId instead of their own copy of the path; id 0 is the empty path.
+class FileTable
+{
+	std::mutex mutex;
+	std::deque<std::string> paths; // deque never relocates its elements
+	std::unordered_map<std::string_view, FileId> lookup;
+
+	FileTable();
+
+public:
+	FileTable(const FileTable &) = delete;
+	FileTable &operator=(const FileTable &) = delete;
+
+	static FileTable &instance();
+
+	FileId intern(std::string_view path);
+
+	const std::string &path(FileId id);
+};
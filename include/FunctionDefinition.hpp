@@ -9,5 +9,6 @@ struct FunctionDefinition
 	bool static_function = false;
 	TypeDefinition return_type;
 	std::vector<std::pair<TypeDefinition, std::string>> parameters;
+	// may be called for several structs at once, so it must only write to structFile
 	std::function<bool(Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)> generate_function;
 };
\ No newline at end of file
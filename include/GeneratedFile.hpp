@@ -0,0 +1,28 @@
+#pragma once
+#include <OutputSink.hpp>
+#include <sstream>
+#include <string>
+
+// An output file rendered into memory. close() hands the contents to the
+// sink of the run, a file that is never closed is not written at all. Kept
+// in the header so dynamic generators can use it without linking the host.
+class GeneratedFile : public std::ostringstream
+{
+	OutputSink &sink;
+	std::string path;
+	bool closed = false;
+
+public:
+	GeneratedFile(OutputSink &sink, std::string path) : sink(sink), path(std::move(path)) {}
+
+	const std::string &getPath() const { return path; }
+
+	void close()
+	{
+		if (!closed)
+		{
+			closed = true;
+			sink.write(path, str());
+		}
+	}
+};
@@ -1,6 +1,8 @@
 #pragma once
 #include <ForwardDeclerations.hpp>
 #include <StructDefinition.hpp>
+#include <ModelOverlay.hpp>
+#include <GeneratedFile.hpp>
 
 struct Generator
 {
@@ -11,7 +13,10 @@ struct Generator
 
 	virtual bool add_generator_specific_content_to_struct(Generator *gen, ProgramStructure *ps, StructDefinition &s) = 0;
 
-	virtual bool generate_files(ProgramStructure ps, std::string out_path) = 0;
+	// ps is shared by every generator and must not be changed, generator
+	// specific content goes into a ModelOverlay. Files go to sink, normally
+	// through a GeneratedFile, never straight to disk
+	virtual bool generate_files(ProgramStructure &ps, std::string out_path, OutputSink &sink) = 0;
 
 	virtual bool add_generator(Generator *gen){
 		return false;
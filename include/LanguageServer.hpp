@@ -0,0 +1,78 @@
+#pragma once
+#include <ParseCache.hpp>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Language Server Protocol over stdio for -lsp. Serves diagnostics,
+// go-to-definition of struct / enum names and completion of keywords and
+// type names. Every edit rebuilds the model from the workspace with the
+// editor's unsaved buffers in place of the files on disk; unchanged files
+// come from an in-memory parse cache, so only the edited file is parsed.
+// Workspace files are read once and then only when the client's file
+// watcher reports them changed, so an edit does no disk I/O.
+class LanguageServer
+{
+	struct Definition
+	{
+		std::string name;
+		int line = 0;	   // 0-based, as the protocol counts
+		int character = 0; // 0-based
+		int length = 0;
+	};
+	struct IndexedFile
+	{
+		uint64_t hash = 0;
+		std::vector<Definition> definitions;
+	};
+
+	std::string root;
+	std::vector<std::string> workspace_files;
+	std::unordered_map<std::string, std::string> open_documents; // by path
+	// text of every input by path, the open documents over the files on disk
+	std::shared_ptr<std::unordered_map<std::string, std::string>> sources;
+	std::map<std::string, IndexedFile> index;					 // by path
+	std::set<std::string> files_with_diagnostics;
+	std::vector<std::string> struct_names;
+	std::vector<std::string> enum_names;
+	std::shared_ptr<ParseCache> parse_cache;
+	bool shutdown_requested = false;
+	bool can_register_watcher = false;
+
+	std::ostream *out = nullptr;
+
+	bool readMessage(std::istream &in, nlohmann::json &message);
+	void send(const nlohmann::json &message);
+	void respond(const nlohmann::json &id, const nlohmann::json &result);
+	void respondError(const nlohmann::json &id, int code, const std::string &message);
+
+	void collectWorkspaceFiles();
+	bool readText(const std::string &path, std::string &text);
+	// rereads a file that is not open from disk, forgets it if it is gone
+	void reloadFile(const std::string &path);
+	void indexFile(const std::string &path);
+	void registerWatcher();
+	void filesChanged(const nlohmann::json &changes);
+	void rebuild();
+
+	// handles one message, false if its params are malformed
+	bool dispatch(const std::string &method, const nlohmann::json &params, const nlohmann::json &id, bool is_request);
+
+	// false if params are malformed, result is null when nothing is found
+	bool definition(const nlohmann::json &params, nlohmann::json &result);
+	nlohmann::json completion();
+
+public:
+	LanguageServer();
+
+	// serves requests until the client sends exit, returns the process exit code
+	int run(std::istream &in, std::ostream &out);
+
+	static std::string uriToPath(const std::string &uri);
+	static std::string pathToUri(const std::string &path);
+};
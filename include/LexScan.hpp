@@ -0,0 +1,188 @@
+#pragma once
+#include <cstddef>
+
+// Block scanners used by the lexer to skip runs of characters that need no
+// per-character decisions. Each returns the length of the run at the start
+// of p, at most n. AVX2 handles 32 bytes per step, SSE2 16, and whatever is
+// left (or everything, without either) goes through the scalar loop.
+// Defining LEX_SCAN_SCALAR_ONLY keeps to the scalar loop on any target, the
+// lexer test uses it to check that path on x86 as well.
+#if defined(__AVX2__) && !defined(LEX_SCAN_SCALAR_ONLY)
+#define LEX_SCAN_AVX2
+#endif
+#if defined(__SSE2__) && !defined(LEX_SCAN_SCALAR_ONLY)
+#define LEX_SCAN_SSE2
+#endif
+#if defined(LEX_SCAN_AVX2) || defined(LEX_SCAN_SSE2)
+#include <immintrin.h>
+#endif
+
+enum CharClass : unsigned char
+{
+	CHAR_WORD,	  // part of an identifier, number or keyword
+	CHAR_BLANK,	  // ' ' and '\t'
+	CHAR_NEWLINE, // '\n'
+	CHAR_SPECIAL, // punctuation that is a token of its own
+	CHAR_QUOTE,	  // '"'
+	CHAR_ESCAPE,  // '\\'
+	CHAR_SLASH,	  // '/', may start a comment
+};
+
+// class of every byte, '\r' and non ASCII bytes are word characters
+struct CharClassTable
+{
+	CharClass classes[256];
+
+	constexpr CharClassTable() : classes()
+	{
+		for (int c = 0; c < 256; c++)
+		{
+			classes[c] = CHAR_WORD;
+		}
+		classes[(unsigned char)' '] = CHAR_BLANK;
+		classes[(unsigned char)'\t'] = CHAR_BLANK;
+		classes[(unsigned char)'\n'] = CHAR_NEWLINE;
+		for (char c : {'{', '}', '(', ')', ',', ';', ':', '<', '>', '=', '.'})
+		{
+			classes[(unsigned char)c] = CHAR_SPECIAL;
+		}
+		classes[(unsigned char)'"'] = CHAR_QUOTE;
+		classes[(unsigned char)'\\'] = CHAR_ESCAPE;
+		classes[(unsigned char)'/'] = CHAR_SLASH;
+	}
+
+	CharClass operator[](char c) const { return classes[(unsigned char)c]; }
+};
+
+inline constexpr CharClassTable char_classes;
+
+namespace lex_scan
+{
+	inline bool isIdentifierChar(char c)
+	{
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+	}
+
+	// mask of the bytes in [lo, hi], bytes >= 0x80 are negative and never match
+#if defined(LEX_SCAN_AVX2)
+	inline __m256i inRange(__m256i v, char lo, char hi)
+	{
+		return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(lo - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), v));
+	}
+#endif
+#if defined(LEX_SCAN_SSE2)
+	inline __m128i inRange(__m128i v, char lo, char hi)
+	{
+		return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8(hi + 1)));
+	}
+#endif
+}
+
+// run of [A-Za-z0-9_]
+inline size_t scanIdentifier(const char *p, size_t n)
+{
+	size_t i = 0;
+#if defined(LEX_SCAN_AVX2)
+	for (; i + 32 <= n; i += 32)
+	{
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+		__m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+		__m256i match = _mm256_or_si256(_mm256_or_si256(lex_scan::inRange(lower, 'a', 'z'), lex_scan::inRange(v, '0', '9')),
+										_mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+		unsigned mask = ~(unsigned)_mm256_movemask_epi8(match);
+		if (mask != 0)
+		{
+			return i + __builtin_ctz(mask);
+		}
+	}
+#endif
+#if defined(LEX_SCAN_SSE2)
+	for (; i + 16 <= n; i += 16)
+	{
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+		__m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+		__m128i match = _mm_or_si128(_mm_or_si128(lex_scan::inRange(lower, 'a', 'z'), lex_scan::inRange(v, '0', '9')),
+									 _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+		unsigned mask = ~(unsigned)_mm_movemask_epi8(match) & 0xFFFF;
+		if (mask != 0)
+		{
+			return i + __builtin_ctz(mask);
+		}
+	}
+#endif
+	while (i < n && lex_scan::isIdentifierChar(p[i]))
+	{
+		i++;
+	}
+	return i;
+}
+
+// run of ' ' and '\t'
+inline size_t scanBlanks(const char *p, size_t n)
+{
+	size_t i = 0;
+#if defined(LEX_SCAN_AVX2)
+	for (; i + 32 <= n; i += 32)
+	{
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+		__m256i match = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')));
+		unsigned mask = ~(unsigned)_mm256_movemask_epi8(match);
+		if (mask != 0)
+		{
+			return i + __builtin_ctz(mask);
+		}
+	}
+#endif
+#if defined(LEX_SCAN_SSE2)
+	for (; i + 16 <= n; i += 16)
+	{
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+		__m128i match = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+		unsigned mask = ~(unsigned)_mm_movemask_epi8(match) & 0xFFFF;
+		if (mask != 0)
+		{
+			return i + __builtin_ctz(mask);
+		}
+	}
+#endif
+	while (i < n && (p[i] == ' ' || p[i] == '\t'))
+	{
+		i++;
+	}
+	return i;
+}
+
+// run of anything but '"' and '\\', the body of a string literal
+inline size_t scanStringBody(const char *p, size_t n)
+{
+	size_t i = 0;
+#if defined(LEX_SCAN_AVX2)
+	for (; i + 32 <= n; i += 32)
+	{
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+		__m256i match = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+		unsigned mask = (unsigned)_mm256_movemask_epi8(match);
+		if (mask != 0)
+		{
+			return i + __builtin_ctz(mask);
+		}
+	}
+#endif
+#if defined(LEX_SCAN_SSE2)
+	for (; i + 16 <= n; i += 16)
+	{
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+		__m128i match = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+		unsigned mask = (unsigned)_mm_movemask_epi8(match);
+		if (mask != 0)
+		{
+			return i + __builtin_ctz(mask);
+		}
+	}
+#endif
+	while (i < n && p[i] != '"' && p[i] != '\\')
+	{
+		i++;
+	}
+	return i;
+}
@@ -2,6 +2,7 @@
 #include <ForwardDeclerations.hpp>
 #include <TypeDefinition.hpp>
 #include <ReferenceDefinition.hpp>
+#include <Token.hpp>
 
 struct MemberVariableDefinition
 {
@@ -20,10 +21,13 @@ struct MemberVariableDefinition
 	int max_items = 0;
 
 	bool in_class_init = false;
-	std::function<bool(ProgramStructure *ps, MemberVariableDefinition &mv, std::ofstream &structFile)> generate_initializer;
+	std::function<bool(ProgramStructure *ps, MemberVariableDefinition &mv, std::ostream &structFile)> generate_initializer;
 
 	bool static_member = false;
 	bool const_member = false;
 	std::set<std::string> enabled_for_generators;
 	std::set<std::string> disabled_for_generators;
+
+	// where the member is defined, for errors found after parsing
+	SourcePosition position;
 };
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+#include <ForwardDeclerations.hpp>
+#include <StructDefinition.hpp>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Generator specific changes to the model every generator shares. The model
+// itself is never modified: a struct is copied into the overlay the first time
+// a generator edits it and every other struct is read straight from the model.
+class ModelOverlay
+{
+	ProgramStructure *model;
+	std::vector<std::unique_ptr<StructDefinition>> edited; // by struct index
+
+public:
+	explicit ModelOverlay(ProgramStructure &model);
+
+	size_t size() const;
+
+	// the edited copy of a struct if there is one, the shared struct otherwise,
+	// which must only be read
+	StructDefinition &get(size_t index);
+
+	// copy of a struct that may be changed, made on first use
+	StructDefinition &edit(size_t index);
+
+	// edit by name, nullptr if the model has no such struct
+	StructDefinition *edit(std::string_view identifier);
+};
@@ -0,0 +1,21 @@
+#pragma once
+#include <string>
+
+// Collects what the current thread writes to std::cout into a string for as
+// long as it is alive, so work running on several threads can print its
+// messages in a fixed order afterwards. Other threads keep writing to the
+// console. install() has to run before a second thread writes to std::cout,
+// calling it again once installed does nothing.
+class OutputCapture
+{
+	std::string *previous;
+
+public:
+	static void install();
+
+	explicit OutputCapture(std::string &buffer);
+	~OutputCapture();
+
+	OutputCapture(const OutputCapture &) = delete;
+	OutputCapture &operator=(const OutputCapture &) = delete;
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include <OutputSink.hpp>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Process wide record of what the generators last wrote to each output
+// directory, kept next to the outputs in a manifest file; FileSystemSink
+// writes through it. A generated file is only written when its contents hash
+// differently from the previous run, so unchanged outputs keep their mtimes
+// and downstream builds skip them. Changed files are handed to the
+// OutputWriter and written in the background. Files the previous run wrote
+// to a directory but a complete run did not produce again belong to removed
+// definitions and are deleted.
+class OutputManifest
+{
+	struct Entry
+	{
+		uint64_t hash = 0;
+		uint64_t size = 0;
+		int64_t mtime = 0; // of the file as written, to notice edits by hand
+	};
+	struct Directory
+	{
+		std::map<std::string, Entry> entries; // by file name
+		std::set<std::string> produced;		  // file names written or unchanged this run
+		bool complete = false;				  // every file of this run has been produced
+		bool changed = false;
+	};
+	std::mutex mutex;
+	std::map<std::string, Directory> directories; // by path, read on first use
+	bool verbose = false;
+	size_t written = 0;
+	size_t unchanged = 0;
+	std::vector<std::string> failed; // paths
+
+	static std::string key(const std::string &directory_path);
+
+	OutputManifest() = default;
+
+	// must be called with mutex held
+	Directory &directory(const std::string &path);
+
+public:
+	OutputManifest(const OutputManifest &) = delete;
+	OutputManifest &operator=(const OutputManifest &) = delete;
+
+	static constexpr const char *file_name = ".schemalang_manifest";
+
+	static OutputManifest &instance();
+
+	// prints every file as it is generated instead of only the totals
+	void setVerbose(bool value) { verbose = value; }
+
+	// queues data to be written to path unless the previous run already left
+	// exactly this there
+	void write(const std::string &path, std::string data);
+
+	// marks a directory whose generator finished without errors, so files the
+	// previous run left there and this run did not produce are stale
+	void complete(const std::string &directory_path);
+
+	// waits for the queued files, prints the ones that could not be written,
+	// deletes the stale files of complete directories and stores the manifest
+	// of every directory changed since the last save; totals count the files
+	// of the run that ends here
+	bool save(OutputTotals &totals);
+};
@@ -0,0 +1,88 @@
+#pragma once
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+// what happened to the files of one generation run
+struct OutputTotals
+{
+	size_t written = 0;
+	size_t unchanged = 0;
+	size_t failed = 0;
+	size_t removed = 0;
+};
+
+// Destination of generated files. Generators render every file into a
+// GeneratedFile, which hands it to the sink of the run on close(); nothing in
+// a generator touches the disk itself. write may be called from several
+// threads at once. The methods are virtual so dynamic generators, which can
+// not link against the host, end up in the host's implementation.
+class OutputSink
+{
+public:
+	virtual ~OutputSink() = default;
+
+	// path is the out_path the generator was given + "/" + the file name
+	virtual void write(const std::string &path, std::string data) = 0;
+
+	// the generator writing to directory_path finished without errors
+	virtual void complete(const std::string &/*directory_path*/) {}
+
+	// ends a generation run, returns false if some output was lost
+	virtual bool finish(OutputTotals &totals) = 0;
+};
+
+// Writes to the file system through the OutputManifest: unchanged files are
+// skipped, changed ones are written in the background and files removed
+// definitions left behind are deleted.
+class FileSystemSink : public OutputSink
+{
+public:
+	void write(const std::string &path, std::string data) override;
+	void complete(const std::string &directory_path) override;
+	bool finish(OutputTotals &totals) override;
+};
+
+// Keeps every file in memory, for callers that run generation in-process and
+// use the output directly.
+class MemorySink : public OutputSink
+{
+	std::mutex mutex;
+	std::map<std::string, std::string> files; // by path
+	size_t written = 0;
+
+public:
+	void write(const std::string &path, std::string data) override;
+	bool finish(OutputTotals &totals) override;
+
+	// the files of every run so far, a file written again holds the latest contents
+	const std::map<std::string, std::string> &getFiles() const { return files; }
+};
+
+// Collects the files and writes them as one tar archive when the run
+// finishes. Entries are named relative to root and carry no timestamps, so
+// the same input always gives the same archive. Entries of earlier runs are
+// kept, so a run that renders only some definitions updates the archive like
+// it would the output directory; a completed directory drops what it no
+// longer writes.
+class ArchiveSink : public OutputSink
+{
+	std::string archive_path;
+	std::string root;
+	std::mutex mutex;
+	std::map<std::string, std::string> files; // by name in the archive
+	std::set<std::string> written;			   // names written this run
+	std::vector<std::string> completed;		   // name prefixes of completed directories
+
+	std::string entryName(const std::string &path) const;
+
+public:
+	ArchiveSink(std::string archive_path, std::string root) : archive_path(std::move(archive_path)), root(std::move(root)) {}
+
+	void write(const std::string &path, std::string data) override;
+	void complete(const std::string &directory_path) override;
+	bool finish(OutputTotals &totals) override;
+};
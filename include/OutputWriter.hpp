@@ -0,0 +1,49 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Writes finished output files on a background thread, so the generators go
+// on rendering while the file system catches up. Every file is written
+// atomically and done is called with the result on the writer thread. When
+// more than max_queued_bytes are waiting, write() blocks until the writer
+// has caught up, which bounds the memory held by rendered files.
+class OutputWriter
+{
+	struct Job
+	{
+		std::string path;
+		std::string data;
+		std::function<void(bool ok)> done;
+	};
+	std::mutex mutex;
+	std::condition_variable queued;	  // wakes the writer thread
+	std::condition_variable progress; // wakes blocked write() and wait() calls
+	std::deque<Job> jobs;
+	size_t queued_bytes = 0;
+	bool busy = false;
+	bool stopping = false;
+	std::thread thread;
+
+	OutputWriter();
+	~OutputWriter();
+
+	void run();
+
+public:
+	OutputWriter(const OutputWriter &) = delete;
+	OutputWriter &operator=(const OutputWriter &) = delete;
+
+	static constexpr size_t max_queued_bytes = 64 * 1024 * 1024;
+
+	static OutputWriter &instance();
+
+	void write(std::string path, std::string data, std::function<void(bool ok)> done);
+
+	// blocks until every queued file has been written
+	void wait();
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Runs body(i) for every i in [0, count) on up to jobs threads, 0 jobs uses
+// one thread per core. Indices are handed out one at a time so uneven work
+// still balances; the calling thread works too and returns when all are done.
+inline void parallelFor(size_t count, unsigned jobs, const std::function<void(size_t)> &body)
+{
+	if (jobs == 0)
+	{
+		jobs = std::max(1u, std::thread::hardware_concurrency());
+	}
+	size_t thread_count = std::min<size_t>(jobs, count);
+	if (thread_count <= 1)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			body(i);
+		}
+		return;
+	}
+
+	std::atomic<size_t> next{0};
+	auto worker = [&]()
+	{
+		for (size_t i = next++; i < count; i = next++)
+		{
+			body(i);
+		}
+	};
+	std::vector<std::thread> threads;
+	for (size_t t = 1; t < thread_count; t++)
+	{
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (auto &thread : threads)
+	{
+		thread.join();
+	}
+}
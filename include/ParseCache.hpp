@@ -0,0 +1,55 @@
+#pragma once
+#include <FileParse.hpp>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Cache of FileParse results, one entry per schema source. An entry is keyed
+// by the source path, its contents and the parser version, so any edit or a
+// change of the parser output format simply misses and the file is parsed again.
+// Entries are written to directory when one is set, and can additionally be
+// kept in memory for a process that parses the same files repeatedly.
+class ParseCache
+{
+	std::string directory;
+	std::string version;
+
+	bool keep_in_memory = false;
+	struct MemoryEntry
+	{
+		uint64_t size;
+		uint64_t hash;
+		FileParse parse;
+	};
+	std::mutex memory_mutex;
+	std::unordered_map<std::string, MemoryEntry> memory; // by file path
+
+	std::string entryPath(const std::string &file_path, std::string_view contents) const;
+
+	bool loadFromDisk(const std::string &file_path, std::string_view contents, FileParse &parse) const;
+
+	bool storeToDisk(const std::string &file_path, std::string_view contents, const FileParse &parse) const;
+
+public:
+	ParseCache(std::string directory, std::string version) : directory(std::move(directory)), version(std::move(version)) {}
+
+	void setDirectory(const std::string &value) { directory = value; }
+	const std::string &getDirectory() const { return directory; }
+	void setKeepInMemory(bool value) { keep_in_memory = value; }
+
+	// 64 bit FNV-1a
+	static uint64_t hash(std::string_view data, uint64_t seed = 14695981039346656037ull);
+
+	// hash of everything the parser stores for a definition, equal
+	// definitions have equal fingerprints
+	static uint64_t fingerprint(const StructDefinition &s);
+	static uint64_t fingerprint(const EnumDefinition &e);
+
+	// fills parse from the cache, returns false on a miss or a damaged entry
+	bool load(const std::string &file_path, std::string_view contents, FileParse &parse);
+
+	// remembers parse for the file, returns false if it can not be cached
+	bool store(const std::string &file_path, std::string_view contents, const FileParse &parse);
+};
@@ -8,7 +8,7 @@ struct PrivateVariableDefinition
 	TypeDefinition type;
 	std::string identifier = "";
 	bool in_class_init = false;
-	std::function<bool(ProgramStructure *ps, PrivateVariableDefinition &mv, std::ofstream &structFile)> generate_initializer;
+	std::function<bool(ProgramStructure *ps, PrivateVariableDefinition &mv, std::ostream &structFile)> generate_initializer;
 	bool static_member = false;
 	bool const_member = false;
 };
\ No newline at end of file
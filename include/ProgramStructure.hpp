@@ -3,43 +3,30 @@
 #include <Generator.hpp>
 #include <StructDefinition.hpp>
 #include <EnumDefinition.hpp>
-
-struct SourcePosition
-{
-	std::string file_path;
-	int line;
-	int column;
-	
-	SourcePosition() : line(1), column(1) {}
-	SourcePosition(const std::string& file, int l, int c) : file_path(file), line(l), column(c) {}
-};
-
-struct Token
-{
-	std::string value;
-	SourcePosition position;
-	
-	Token() {}
-	Token(const std::string& val, const SourcePosition& pos) : value(val), position(pos) {}
-	
-	// Comparison operators for convenience
-	bool operator==(const std::string& str) const { return value == str; }
-	bool operator!=(const std::string& str) const { return value != str; }
-	bool operator==(const char* str) const { return value == str; }
-	bool operator!=(const char* str) const { return value != str; }
-	
-	// Implicit conversion to string for compatibility
-	operator const std::string&() const { return value; }
-};
+#include <SourceManager.hpp>
+#include <ParseCache.hpp>
+#include <StringInterner.hpp>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <Token.hpp>
+#include <TokenStream.hpp>
 
 struct ProgramStructure
 {
 	// Current parsing context
 	std::vector<std::string> already_included_files;
+	std::unordered_set<std::string> included_file_set; // the same paths, for lookups
 	std::string current_file;
 	SourcePosition current_position;
 
-	bool isInt(std::string str);
+	// mapped schema sources and interned token text, shared between copies
+	// so tokens stay valid for as long as any copy of the structure exists
+	std::shared_ptr<SourceManager> source_manager = std::make_shared<SourceManager>();
+	std::shared_ptr<StringInterner> interner = std::make_shared<StringInterner>();
+
+	bool isInt(std::string_view str);
 
 	bool isBreakChar(std::string str);
 
@@ -49,47 +36,158 @@ struct ProgramStructure
 
 	bool isSpecialBreakChar(char c);
 
-	std::vector<Token> tokenizeWithPosition(std::string str, const std::string& file_path);
+	// tokens are views into str, which has to outlive them
+	std::vector<Token> tokenizeWithPosition(std::string_view str, const std::string& file_path);
 	std::vector<std::string> tokenize(std::string str); // Keep for backward compatibility
 
+	// where diagnostics go, stdout unless a buffer is set
+	std::string *diagnostics = nullptr;
+	void printDiagnostic(const char *format, ...);
+
+	// every error reported so far, for tools that need them as data
+	struct ReportedError
+	{
+		SourcePosition position;
+		size_t length = 0; // length of the offending token, 0 if there is none
+		std::string message;
+	};
+	std::vector<ReportedError> reported_errors;
+
 	void reportError(const std::string& message);
 	void reportError(const std::string& message, const SourcePosition& position);
 	void reportError(const std::string& message, const Token& token);
 
-	bool readMemberVariable(std::vector<Token> tokens, int &i, MemberVariableDefinition &current_MemberVariableDefinition);
+	// initializer the parser gives array members
+	static bool writeEmptyInitializer(ProgramStructure *ps, MemberVariableDefinition &mv, std::ostream &structFile);
 
-	bool readStruct(std::vector<Token> tokens, int &i, StructDefinition &current_struct);
+	bool readMemberVariable(TokenStream &tokens, MemberVariableDefinition &current_MemberVariableDefinition);
 
-	bool readEnumValue(std::vector<Token> tokens, int &i, EnumDefinition &current_enum, int &curent_index);
+	bool readMemberVariableModifier(TokenStream &tokens, MemberVariableDefinition &current_MemberVariableDefinition);
 
-	bool readEnum(std::vector<Token> tokens, int &i, EnumDefinition &current_enum);
+	bool readStruct(TokenStream &tokens, StructDefinition &current_struct);
 
-	bool readConfig(std::vector<Token> tokens, int &i);
+	bool readEnumValue(TokenStream &tokens, EnumDefinition &current_enum, int &curent_index);
+
+	bool readEnum(TokenStream &tokens, EnumDefinition &current_enum);
+
+	bool readConfig(TokenStream &tokens);
+
+	// opens and lexes file_path into source_manager and collects its type names
+	SourceBuffer *lexFile(const std::string &file_path);
+
+	SourceBuffer *openFile(const std::string &file_path);
+
+	bool lexSource(SourceBuffer *source, const std::string &file_path);
+
+	// reads the top level statements of one file
+	bool readDefinitions(const std::vector<Token> &tokens, const std::string &file_path);
+
+	// set by readFiles while a file is parsed on its own: definitions and
+	// includes are recorded for the merge instead of being followed, and
+	// names from the other input files count as known types
+	FileParse *recording = nullptr;
+	const std::unordered_set<std::string_view> *known_type_names = nullptr;
+	const std::unordered_set<std::string_view> *known_struct_names = nullptr;
+
+	StructDefinition &defineStruct(StructDefinition s);
+
+	EnumDefinition &defineEnum(EnumDefinition e);
 
 	bool validate();
 
 	std::vector<StructDefinition> structs;
 	std::vector<EnumDefinition> enums;
-	std::vector<std::string> type_names;
+	// struct and enum names seen by parseTypeNames whose definition has not been read yet
+	std::unordered_set<std::string_view> type_names;
+
+	// symbol table mapping a name to its index in structs / enums,
+	// keys are views into the interner so they survive vector growth
+	std::unordered_map<std::string_view, size_t> struct_indices;
+	std::unordered_map<std::string_view, size_t> enum_indices;
+
+	// what an interned type refers to in this structure, indexed by TypeEntry::id
+	struct TypeResolution
+	{
+		TypeKind kind = TypeKind::Other;
+		size_t index = 0;
+	};
+	std::vector<TypeResolution> type_resolutions;
+
+	void resolveType(std::string_view name, TypeKind kind, size_t index);
+
+	// adds a definition, or merges it into an existing one with the same name.
+	// Pass an rvalue to move a new definition into place instead of copying it.
+	StructDefinition &addStruct(StructDefinition s);
+
+	EnumDefinition &addEnum(EnumDefinition e);
 
 public:
-	bool tokenIsType(std::string token);
+	bool tokenIsType(std::string_view token);
 
-	bool tokenIsStruct(std::string token);
+	bool tokenIsStruct(std::string_view token);
+
+	bool tokenIsEnum(std::string_view token);
+
+	bool tokenIsValidTypeName(std::string_view token);
+
+	// O(1) classification of a type, struct and enum names resolve to this structure's definitions
+	TypeKind getTypeKind(const TypeDefinition &type) const
+	{
+		const TypeEntry *entry = type.getEntry();
+		if (entry->kind != TypeKind::Other || entry->id >= type_resolutions.size())
+		{
+			return entry->kind;
+		}
+		return type_resolutions[entry->id].kind;
+	}
 
-	bool tokenIsEnum(std::string token);
+	// definition a struct type refers to, nullptr if it is not a struct
+	StructDefinition *getTypeStruct(const TypeDefinition &type);
 
-	bool tokenIsValidTypeName(std::string token);
+	EnumDefinition *getTypeEnum(const TypeDefinition &type);
 
 	StructDefinition &getStruct(std::string identifier);
 
 	EnumDefinition &getEnum(std::string identifier);
 
-    bool parseTypeNames(std::vector<Token> tokens);
+    bool parseTypeNames(const std::vector<Token> &tokens);
+
+	// reads file_path and its includes, then validates the whole structure
+	bool readFile(std::string file_path);
+
+	// reads file_path and its includes without validating, includes are
+	// loaded this way so the model is only validated once it is complete
+	bool loadFile(const std::string &file_path);
+
+	// unsaved editor contents by path, read instead of the file on disk
+	std::shared_ptr<const std::unordered_map<std::string, std::string>> unsaved_files;
+
+	// parse cache used by readFiles, shared between copies, null disables it
+	std::shared_ptr<ParseCache> parse_cache;
+
+	// identifies the parser output format, cache entries of another version are ignored
+	static const char *parserVersion();
+
+	// reads several files and their includes, lexing and parsing them on up to
+	// jobs threads (0 = one per core). The results are merged in the same order
+	// readFile would have read them and validated once at the end.
+	// on_file_read is called for every file in file_paths once it is merged.
+	bool readFiles(const std::vector<std::string> &file_paths, unsigned jobs = 0, const std::function<void(const std::string &, bool)> &on_file_read = nullptr);
+
+	// saves the structs and enums of a validated structure as a compiled
+	// schema image, which readCompiled loads without lexing, parsing or validating
+	bool writeCompiled(const std::string &file_path);
+
+	// maps a compiled schema image and adds its definitions to this structure
+	bool readCompiled(const std::string &file_path);
 
-    bool readFile(std::string file_path);
+	bool generate_files(Generator *gen, std::string out_path, OutputSink &sink);
 
-	bool generate_files(Generator *gen, std::string out_path);
+	// Set by -watch when it regenerates after a change: generators only render
+	// the files of the structs and enums named here, files shared by every
+	// definition are always rendered. Empty renders every definition.
+	std::unordered_set<std::string> render_only;
+	bool rendersDefinition(const std::string &identifier) const { return render_only.empty() || render_only.count(identifier) != 0; }
 
 	std::vector<StructDefinition> &getStructs();
 
@@ -0,0 +1,136 @@
+#pragma once
+#include <StructDefinition.hpp>
+#include <EnumDefinition.hpp>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Binary encoding of parsed definitions, shared by the parse cache and
+// compiled schema images. Values are written in host byte order without
+// padding, and every read is bounds checked.
+
+// appends binary encoded values to out
+struct CacheWriter
+{
+	std::string out;
+
+	void u8(uint8_t value) { out.push_back((char)value); }
+	void u32(uint32_t value) { out.append((const char *)&value, sizeof(value)); }
+	void i32(int32_t value) { out.append((const char *)&value, sizeof(value)); }
+	void u64(uint64_t value) { out.append((const char *)&value, sizeof(value)); }
+	void str(std::string_view value)
+	{
+		u32((uint32_t)value.size());
+		out.append(value.data(), value.size());
+	}
+	template <typename Container>
+	void strings(const Container &values)
+	{
+		u32((uint32_t)values.size());
+		for (const auto &value : values)
+		{
+			str(value);
+		}
+	}
+	template <typename Container>
+	void pairs(const Container &values)
+	{
+		u32((uint32_t)values.size());
+		for (const auto &[generator, value] : values)
+		{
+			str(generator);
+			str(value);
+		}
+	}
+};
+
+// reads what CacheWriter wrote, ok turns false on the first out of range read
+struct CacheReader
+{
+	std::string_view in;
+	size_t pos = 0;
+	bool ok = true;
+
+	bool take(void *dest, size_t size)
+	{
+		if (!ok || in.size() - pos < size)
+		{
+			ok = false;
+			return false;
+		}
+		memcpy(dest, in.data() + pos, size);
+		pos += size;
+		return true;
+	}
+	uint8_t u8()
+	{
+		uint8_t value = 0;
+		take(&value, sizeof(value));
+		return value;
+	}
+	uint32_t u32()
+	{
+		uint32_t value = 0;
+		take(&value, sizeof(value));
+		return value;
+	}
+	int32_t i32()
+	{
+		int32_t value = 0;
+		take(&value, sizeof(value));
+		return value;
+	}
+	uint64_t u64()
+	{
+		uint64_t value = 0;
+		take(&value, sizeof(value));
+		return value;
+	}
+	std::string str()
+	{
+		uint32_t size = u32();
+		if (!ok || in.size() - pos < size)
+		{
+			ok = false;
+			return std::string();
+		}
+		std::string value(in.substr(pos, size));
+		pos += size;
+		return value;
+	}
+	// element counts are bounded by the remaining input so a damaged entry
+	// can not ask for a huge allocation
+	uint32_t count()
+	{
+		uint32_t value = u32();
+		if (value > in.size() - pos)
+		{
+			ok = false;
+			return 0;
+		}
+		return value;
+	}
+};
+
+void write_member_variable(CacheWriter &w, const MemberVariableDefinition &mv);
+void read_member_variable(CacheReader &r, MemberVariableDefinition &mv);
+
+// returns false for definitions holding generator content, which can not be encoded
+bool write_struct(CacheWriter &w, const StructDefinition &def);
+void read_struct(CacheReader &r, StructDefinition &def);
+
+// where a struct and its members are defined. Kept apart from write_struct so
+// moving a definition around in its file does not change its fingerprint
+void write_positions(CacheWriter &w, const StructDefinition &def);
+void read_positions(CacheReader &r, StructDefinition &def);
+
+void write_enum(CacheWriter &w, const EnumDefinition &e);
+void read_enum(CacheReader &r, EnumDefinition &e);
+
+std::vector<std::string> read_strings(CacheReader &r);
+
+// writes data to a private temporary next to path and renames it into
+// place, so readers never see a half written file
+bool writeFileAtomically(const std::string &path, std::string_view data);
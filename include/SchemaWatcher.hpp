@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Waits for changes to schema files using inotify. Directories are watched
+// rather than files, editors that save by renaming a new file into place
+// would otherwise drop the watch.
+class SchemaWatcher
+{
+	int fd = -1;
+	std::unordered_map<int, std::string> watched_directories; // by watch descriptor
+
+public:
+	SchemaWatcher() {}
+	SchemaWatcher(const SchemaWatcher &) = delete;
+	SchemaWatcher &operator=(const SchemaWatcher &) = delete;
+	~SchemaWatcher();
+
+	// false if file watching is not available on this platform
+	bool open();
+
+	// adds a directory, watching one twice is harmless
+	bool watchDirectory(const std::string &path);
+
+	// blocks until something changes in a watched directory, then collects
+	// the changed paths for settle_ms so one save yields one rebuild
+	std::vector<std::string> wait(int settle_ms = 100);
+};
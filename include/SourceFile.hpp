@@ -0,0 +1,32 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+// Read-only memory mapping of a schema source file.
+// Tokens produced from a SourceFile are views into the mapping, so the
+// SourceFile has to outlive every token that was lexed from it.
+class SourceFile
+{
+	std::string path;
+	boost::interprocess::file_mapping mapping;
+	boost::interprocess::mapped_region region;
+	std::string owned; // text that did not come from disk
+	std::string_view contents;
+
+public:
+	SourceFile() {}
+	SourceFile(const SourceFile &) = delete;
+	SourceFile &operator=(const SourceFile &) = delete;
+
+	// maps the file at file_path, returns false if it can not be opened
+	bool open(const std::string &file_path);
+
+	// uses text in place of the file at file_path, e.g. an unsaved editor buffer
+	void assign(const std::string &file_path, std::string text);
+
+	const std::string &getPath() const { return path; }
+	std::string_view text() const { return contents; }
+	size_t size() const { return contents.size(); }
+};
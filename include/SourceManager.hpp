@@ -0,0 +1,39 @@
+#pragma once
+#include <SourceFile.hpp>
+#include <Token.hpp>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// A loaded schema file together with everything diagnostics need to know
+// about it, so an error never has to read or lex the file a second time.
+struct SourceBuffer
+{
+	SourceFile file;
+	std::vector<size_t> line_starts; // offset of the first character of every line
+	std::vector<Token> tokens;		 // Token::index is the position in this list
+};
+
+// Owns every source buffer loaded while parsing.
+class SourceManager
+{
+	std::vector<std::unique_ptr<SourceBuffer>> buffers;
+	std::unordered_map<FileId, SourceBuffer *> buffers_by_file;
+
+	SourceBuffer *add(std::unique_ptr<SourceBuffer> buffer);
+
+public:
+	// maps file_path and indexes its lines, returns nullptr if it can not be opened
+	SourceBuffer *open(const std::string &file_path);
+
+	// like open, but the file's contents are text instead of what is on disk
+	SourceBuffer *open(const std::string &file_path, std::string text);
+
+	// buffer previously opened for a file, nullptr if there is none
+	const SourceBuffer *find(FileId file_id) const;
+
+	// text of a 1-based line without its line break, empty if out of range
+	static std::string_view line(const SourceBuffer &buffer, int line_no);
+};
@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <deque>
+#include <unordered_set>
+
+// Stores one copy of each distinct string and hands out views to it.
+// Views stay valid for the lifetime of the interner.
+class StringInterner
+{
+	std::deque<std::string> storage; // deque never relocates its elements
+	std::unordered_set<std::string_view> lookup;
+
+public:
+	std::string_view intern(std::string_view str)
+	{
+		auto it = lookup.find(str);
+		if (it != lookup.end())
+		{
+			return *it;
+		}
+		storage.emplace_back(str);
+		return *lookup.insert(storage.back()).first;
+	}
+
+	size_t size() const { return storage.size(); }
+};
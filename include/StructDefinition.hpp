@@ -2,6 +2,7 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <unordered_set>
 #include <FunctionDefinition.hpp>
 #include <PrivateVariableDefinition.hpp>
 #include <MemberVariableDefinition.hpp>
@@ -26,6 +27,9 @@ struct StructDefinition
 	std::string getIdentifier() const { return identifier; }
 	void setIdentifier(const std::string &id) { identifier = id; }
 
+	// where the struct is defined, for errors found after parsing
+	SourcePosition position;
+
 	std::set<generator_otherwise_pair<std::string>>& getIncludes(){
 		return includes;
 	}
@@ -47,6 +51,33 @@ struct StructDefinition
 	std::vector<generator_otherwise_pair<MemberVariableDefinition>>& getMemberVariables(){
 		return member_variables;
 	}
+	const std::set<generator_otherwise_pair<std::string>>& getIncludes() const {
+		return includes;
+	}
+	const std::vector<generator_otherwise_pair<std::string>>& getBeforeLines() const {
+		return before_lines;
+	}
+	const std::vector<generator_otherwise_pair<std::string>>& getBeforeSetterLines() const {
+		return before_setter_lines;
+	}
+	const std::vector<generator_otherwise_pair<std::string>>& getBeforeGetterLines() const {
+		return before_getter_lines;
+	}
+	const std::vector<generator_otherwise_pair<FunctionDefinition>>& getFunctions() const {
+		return functions;
+	}
+	const std::vector<generator_otherwise_pair<PrivateVariableDefinition>>& getPrivateVariables() const {
+		return private_variables;
+	}
+	const std::vector<generator_otherwise_pair<MemberVariableDefinition>>& getMemberVariables() const {
+		return member_variables;
+	}
+	const std::set<std::string>& getGensEnabled() const {
+		return enabled_for_generators;
+	}
+	const std::set<std::string>& getGensDisabled() const {
+		return disabled_for_generators;
+	}
 
 
 	bool add_include(std::string include, std::string generator = "");
@@ -63,9 +94,9 @@ struct StructDefinition
 	bool has_before_line(std::string line);
 	bool has_before_setter_line(std::string line);
 	bool has_before_getter_line(std::string line);
-	bool has_function(std::string identifier);
-	bool has_private_variable(std::string identifier);
-	bool has_member_variable(std::string identifier);
+	bool has_function(const std::string &identifier) const;
+	bool has_private_variable(const std::string &identifier) const;
+	bool has_member_variable(const std::string &identifier) const;
 
 	void clear();
 
@@ -74,7 +105,7 @@ struct StructDefinition
     bool whitelist();
 	bool blacklist();
 
-	void update(StructDefinition def);
+	void update(const StructDefinition &def);
 private:
 	std::set<generator_otherwise_pair<std::string>> includes;
 	std::vector<generator_otherwise_pair<std::string>> before_lines;
@@ -90,4 +121,11 @@ private:
 
 	std::set<std::string> enabled_for_generators;
 	std::set<std::string> disabled_for_generators;
+
+	// identifiers of the functions, private and member variables for the has_*
+	// lookups, kept in step by the add_* functions and clear(), so entries must
+	// only be added through those
+	std::unordered_set<std::string> function_names;
+	std::unordered_set<std::string> private_variable_names;
+	std::unordered_set<std::string> member_variable_names;
 };
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Process wide cache of the embedded resource files. A file is read out of
+// the embedded file system the first time it is asked for and kept for the
+// rest of the run, so every generator (and every thread) shares one copy and
+// the views handed out stay valid until exit. Dynamic generators get the
+// instance through setTemplateCache; the methods are virtual so calls from a
+// library land in the host's copy.
+class TemplateCache
+{
+	std::mutex mutex;
+	std::unordered_map<std::string, std::unique_ptr<std::string>> files; // by embedded path
+	std::map<std::string, std::vector<std::string>> listings;			 // by directory
+
+	TemplateCache() = default;
+
+public:
+	TemplateCache(const TemplateCache &) = delete;
+	TemplateCache &operator=(const TemplateCache &) = delete;
+	virtual ~TemplateCache() = default;
+
+	static TemplateCache &instance();
+
+	// contents of an embedded file, empty if there is no such file
+	virtual std::string_view load(const std::string &path);
+
+	// names of the files in an embedded directory
+	virtual const std::vector<std::string> &list(const std::string &directory);
+};
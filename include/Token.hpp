@@ -0,0 +1,46 @@
+#pragma once
+#include <FileTable.hpp>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Trivially copyable, the path lives once in the FileTable.
+struct SourcePosition
+{
+	FileId file_id;
+	int line;
+	int column;
+	
+	SourcePosition() : file_id(0), line(1), column(1) {}
+	SourcePosition(FileId file, int l, int c) : file_id(file), line(l), column(c) {}
+	SourcePosition(std::string_view file, int l, int c) : file_id(FileTable::instance().intern(file)), line(l), column(c) {}
+
+	const std::string &file_path() const { return FileTable::instance().path(file_id); }
+};
+
+// value is a view into the mapped SourceFile or into the ProgramStructure's
+// StringInterner, it must not outlive the ProgramStructure that lexed it.
+// A token is a plain 32 byte value: view, position and index.
+struct Token
+{
+	std::string_view value;
+	SourcePosition position;
+	// index in the token list of the SourceBuffer it was lexed from, -1 if unknown
+	int index = -1;
+	
+	Token() {}
+	Token(std::string_view val, const SourcePosition& pos, int idx = -1) : value(val), position(pos), index(idx) {}
+	
+	// Comparison operators for convenience
+	bool operator==(std::string_view str) const { return value == str; }
+	bool operator!=(std::string_view str) const { return value != str; }
+	bool operator==(const char* str) const { return value == str; }
+	bool operator!=(const char* str) const { return value != str; }
+	
+	std::string str() const { return std::string(value); }
+
+	// Implicit conversion to string for compatibility
+	operator std::string() const { return str(); }
+};
+
+static_assert(std::is_trivially_copyable_v<Token>, "tokens are copied around by value");
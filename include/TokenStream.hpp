@@ -0,0 +1,59 @@
+#pragma once
+#include <Token.hpp>
+#include <vector>
+#include <algorithm>
+
+// Cursor over the tokens of one source file. The recursive-descent parser
+// shares a single TokenStream instead of copying the token vector into every
+// read* call. Reads past the last token return an empty token positioned at
+// the end of the file, so a truncated schema reports an error instead of
+// indexing out of range.
+class TokenStream
+{
+	const std::vector<Token> &tokens;
+	size_t index = 0;
+	Token end_token;
+
+public:
+	TokenStream(const std::vector<Token> &tokens) : tokens(tokens)
+	{
+		if (!tokens.empty())
+		{
+			end_token.position = tokens.back().position;
+		}
+	}
+
+	bool atEnd() const { return index >= tokens.size(); }
+
+	size_t getIndex() const { return index; }
+
+	// token offset places ahead of the cursor
+	const Token &peek(size_t offset = 0) const
+	{
+		return index + offset < tokens.size() ? tokens[index + offset] : end_token;
+	}
+
+	// returns the current token and moves past it
+	const Token &next()
+	{
+		const Token &token = peek();
+		advance();
+		return token;
+	}
+
+	void advance(size_t count = 1)
+	{
+		index = std::min(index + count, tokens.size());
+	}
+
+	// consumes the current token only if it matches value
+	bool accept(std::string_view value)
+	{
+		if (atEnd() || tokens[index] != value)
+		{
+			return false;
+		}
+		index++;
+		return true;
+	}
+};
@@ -1,39 +1,51 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <ForwardDeclerations.hpp>
+#include <TypeTable.hpp>
 
+// Handle to an interned type. Copying is cheap and identical types share one
+// entry, so comparing two TypeDefinitions is a pointer comparison.
 class TypeDefinition
 {
-	std::string ident;
-	TypeDefinition *elem_type;
+	const TypeEntry *entry;
 	bool defaulted = false;
 public:
 	TypeDefinition();
-	TypeDefinition(std::string ident);
-    TypeDefinition(std::string ident, bool defaulted);
-    TypeDefinition(std::string ident, TypeDefinition elem_type);
-    std::string &identifier();
-	bool is_array();
-	bool is_struct(ProgramStructure*ps);
-	bool is_enum(ProgramStructure*ps);
-	bool is_base_type();
-	bool is_number();
-	bool is_integer();
-	bool is_real();
-	bool is_bool();
-	bool is_string();
-	bool is_char();
-	bool is_array_of_struct(ProgramStructure*ps);
-	bool is_array_of_enum(ProgramStructure*ps);
-	bool is_array_of_base_type();
-	bool is_array_of_number();
-	bool is_array_of_integer();
-	bool is_array_of_real();
-	bool is_array_of_bool();
-	bool is_array_of_string();
-	bool is_array_of_char();
-	bool is_optional();
+	TypeDefinition(std::string_view ident);
+	TypeDefinition(const std::string &ident) : TypeDefinition(std::string_view(ident)) {}
+	TypeDefinition(const char *ident) : TypeDefinition(std::string_view(ident)) {}
+	TypeDefinition(std::string_view ident, bool defaulted);
+	TypeDefinition(std::string_view ident, TypeDefinition elem_type);
+	const std::string &identifier() const;
+	void setIdentifier(std::string_view ident);
+	const TypeEntry *getEntry() const { return entry; }
+	TypeKind kind(ProgramStructure *ps) const;
+	bool is_array() const;
+	bool is_struct(ProgramStructure*ps) const;
+	bool is_enum(ProgramStructure*ps) const;
+	bool is_base_type() const;
+	bool is_number() const;
+	bool is_integer() const;
+	bool is_real() const;
+	bool is_bool() const;
+	bool is_string() const;
+	bool is_char() const;
+	bool is_array_of_struct(ProgramStructure*ps) const;
+	bool is_array_of_enum(ProgramStructure*ps) const;
+	bool is_array_of_base_type() const;
+	bool is_array_of_number() const;
+	bool is_array_of_integer() const;
+	bool is_array_of_real() const;
+	bool is_array_of_bool() const;
+	bool is_array_of_string() const;
+	bool is_array_of_char() const;
+	bool is_optional() const;
 	bool is_defaulted() const { return defaulted; }
 	void setDefaulted(bool value) { defaulted = value; }
-	TypeDefinition &element_type();
-};
\ No newline at end of file
+	// the element of an array, or an empty type if there is none
+	TypeDefinition element_type() const;
+	void setElementType(TypeDefinition elem_type);
+	bool operator==(const TypeDefinition &other) const { return entry == other.entry; }
+	bool operator!=(const TypeDefinition &other) const { return entry != other.entry; }
+};
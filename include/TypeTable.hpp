@@ -0,0 +1,88 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+enum class TypeKind
+{
+	Other, // generator specific spelling or a name that is not a struct / enum (yet)
+	Base,
+	Array,
+	Struct,
+	Enum
+};
+
+// classification of base types, computed once when a type is interned
+enum TypeFlags : unsigned
+{
+	TYPE_BASE = 1 << 0, // includes void, uchar, pointer and array
+	TYPE_NUMBER = 1 << 1,
+	TYPE_INTEGER = 1 << 2,
+	TYPE_REAL = 1 << 3,
+	TYPE_BOOL = 1 << 4,
+	TYPE_STRING = 1 << 5,
+	TYPE_CHAR = 1 << 6,
+	TYPE_ARRAY = 1 << 7,
+	TYPE_OPTIONAL = 1 << 8
+};
+
+// One distinct (identifier, element type) pair. Entries are never freed or
+// moved, so two types are equal exactly when they point to the same entry.
+struct TypeEntry
+{
+	std::string identifier;
+	const TypeEntry *element = nullptr;
+	TypeKind kind = TypeKind::Other;
+	unsigned flags = 0;
+	size_t id = 0; // dense index, used by ProgramStructure to resolve struct / enum names
+};
+
+// Process wide hash-consing table for TypeDefinition. Every member variable
+// and function interns types while files are parsed in parallel, so lookups
+// never take the table exclusively: the empty and base types are created up
+// front and found without a lock, other types under a shared lock, and only
+// a type seen for the first time locks the table.
+class TypeTable
+{
+	struct Key
+	{
+		std::string_view identifier;
+		const TypeEntry *element;
+		bool operator==(const Key &other) const { return identifier == other.identifier && element == other.element; }
+	};
+	struct KeyHash
+	{
+		size_t operator()(const Key &key) const
+		{
+			return std::hash<std::string_view>()(key.identifier) ^ (std::hash<const void *>()(key.element) << 1);
+		}
+	};
+
+	std::shared_mutex mutex;
+	std::deque<TypeEntry> entries; // deque never relocates its elements
+	std::unordered_map<Key, const TypeEntry *, KeyHash> lookup;
+
+	// set by the constructor and never changed, so read without the lock
+	const TypeEntry *empty_type = nullptr;
+	std::unordered_map<std::string_view, const TypeEntry *> base_types;
+
+	TypeTable();
+
+	// adds a new entry, the caller holds the lock
+	const TypeEntry *add(std::string_view identifier, const TypeEntry *element);
+
+public:
+	TypeTable(const TypeTable &) = delete;
+	TypeTable &operator=(const TypeTable &) = delete;
+
+	static TypeTable &instance();
+
+	const TypeEntry *empty() const { return empty_type; }
+
+	const TypeEntry *intern(std::string_view identifier, const TypeEntry *element = nullptr);
+
+	size_t size();
+};
@@ -1,13 +1,8 @@
 #include <BuiltInGenerators/CppGenerator.hpp>
 
-bool CppGenerator::generate_base_class_header_file(Generator *gen, ProgramStructure *ps, std::string out_path)
+bool CppGenerator::generate_base_class_header_file(Generator *gen, ProgramStructure *ps, std::string out_path, OutputSink &sink)
 {
-	std::ofstream baseClassFile(out_path + "/Has" + gen->base_class.getIdentifier() + "Schema.hpp");
-	if (!baseClassFile.is_open())
-	{
-		std::cout << "Failed to open file: " << out_path + "/Has" + gen->base_class.getIdentifier() + "Schema.hpp" << std::endl;
-		return false;
-	}
+	GeneratedFile baseClassFile(sink, out_path + "/Has" + gen->base_class.getIdentifier() + "Schema.hpp");
 	baseClassFile << "#pragma once\n";
 	for (auto &include : gen->base_class.getIncludes())
 	{
@@ -114,13 +109,13 @@ std::string CppGenerator::convert_to_local_type(ProgramStructure *ps, TypeDefini
 	}
 
 	// if the type is a enum, return the identifier
-	if (ps->tokenIsEnum(type.identifier()))
+	if (type.is_enum(ps))
 	{
 		return type.identifier() + "Schema";
 	}
 
 	// if the type is a struct, return the identifier
-	if (ps->tokenIsStruct(type.identifier()))
+	if (type.is_struct(ps))
 	{
 		return type.identifier() + "Schema";
 	}
@@ -188,89 +183,114 @@ bool CppGenerator::add_generator_specific_content_to_struct(Generator *gen, Prog
 	return true;
 }
 
-#include <inja/inja.hpp>
-#include <EmbeddedResources/EmbeddedResourcesEmbeddedVFS.hpp>
+#include <CompiledTemplate.hpp>
+#include <OutputCapture.hpp>
+#include <ParallelFor.hpp>
 
-bool CppGenerator::generate_files(ProgramStructure ps, std::string out_path)
+bool CppGenerator::generate_struct_files(ProgramStructure &ps, StructDefinition &s, const std::vector<StructDefinition> &base_classes, const std::vector<CompiledTemplate> &templates, OutputSink &sink)
 {
-	if (!std::filesystem::exists(out_path))
-	{
-		std::filesystem::create_directories(out_path);
-	}
-	// generate the base class header files
-	std::vector<StructDefinition> base_classes;
+	inja::Environment env;
+	env.set_trim_blocks(true);
+	// env.set_lstrip_blocks(true);
 
-	for (auto &gen : generators)
+	inja::json data;
+	data["struct"] = s.getIdentifier();
+	data["struct_include"] = format_include(s.getIdentifier() + "Schema.hpp");
+
+	data["generators"] = inja::json::object();
+
+	data["functions"] = inja::json::array();
+	for (auto &[generator,f] : s.getFunctions())
 	{
-		if (gen == this)
-		{          
-			continue;
-		}
-		if (!gen->base_class.getIdentifier().empty())
+
+		inja::json function_data;
+		function_data["identifier"] = f.identifier;
+		function_data["return_type"] = convert_to_local_type(&ps, f.return_type);
+		function_data["static"] = f.static_function;
+		function_data["parameters"] = inja::json::array();
+		for (auto &p : f.parameters)
 		{
-			if (!generate_base_class_header_file(gen, &ps, out_path))
+			inja::json parameter_data;
+			parameter_data["type"] = convert_to_local_type(&ps, p.first);
+			parameter_data["identifier"] = p.second;
+			if (!p.first.is_defaulted())
 			{
-				printf("Error: Failed to generate base class header file for %s\n", gen->base_class.getIdentifier().c_str());
-				return false;
+				parameter_data["defaultArg"] = false;
 			}
-			base_classes.push_back(gen->base_class);
+			else
+			{
+				parameter_data["defaultArg"] = get_default_of_type(&ps, p.first);
+			}
+			function_data["parameters"].push_back(parameter_data);
 		}
+		function_data["can_generate_function"] = f.generate_function != nullptr;
 
-		for (auto &s : ps.getStructs())
+		// add the function to the data
+		if (f.generate_function)
+		{
+			std::stringstream ss;
+			f.generate_function(this, &ps, s, f, ss);
+			function_data["generate_function"] = ss.str();
+		}
+		if (f.generator.empty())
+		{
+			data["functions"].push_back(function_data);
+		}
+		else
 		{
-			if (!gen->add_generator_specific_content_to_struct(this, &ps, s))
+			if (data["generators"].find(f.generator) == data["generators"].end())
 			{
-				printf("Error: Failed to add Generator specific functions for %s\n", gen->base_class.getIdentifier().c_str());
-				return false;
+				data["generators"][f.generator] = inja::json::object();
+				data["generators"][f.generator]["functions"] = inja::json::array();
 			}
-		}
-	}
-
-	inja::Environment env;
-	env.set_trim_blocks(true);
-	// env.set_lstrip_blocks(true);
-
-	std::map<std::string, std::string> struct_name_content_pairs;
-	// open file
-	std::vector<std::string> files = listEmbeddedResourcesEmbeddedFiles("/Cpp/struct/");
-	for (auto &file : files)
-	{
-		std::string content(reinterpret_cast<const char *>(loadEmbeddedResourcesEmbeddedFile(("/Cpp/struct/" + file).c_str()).data()), loadEmbeddedResourcesEmbeddedFile(("/Cpp/struct/" + file).c_str()).size());
-		std::string filename = std::filesystem::path(file).filename().string();
-		struct_name_content_pairs[filename] = content;
-	}
 
-	std::map<std::string, std::string> enum_name_content_pairs;
-	files = listEmbeddedResourcesEmbeddedFiles("/Cpp/enum/");
-	for (auto &file : files)
-	{
-		std::string content(reinterpret_cast<const char *>(loadEmbeddedResourcesEmbeddedFile(("/Cpp/enum/" + file).c_str()).data()), loadEmbeddedResourcesEmbeddedFile(("/Cpp/enum/" + file).c_str()).size());
-		std::string filename = std::filesystem::path(file).filename().string();
-		enum_name_content_pairs[filename] = content;
+			data["generators"][f.generator]["functions"].push_back(function_data);
+		}
 	}
 
-	for (auto &s : ps.getStructs())
+	data["includes"] = inja::json::array();
+	for (auto &include : s.getIncludes())
 	{
-		inja::json data;
-		data["struct"] = s.getIdentifier();
-		data["struct_include"] = format_include(s.getIdentifier() + "Schema.hpp");
-
-		data["generators"] = inja::json::object();
-
-		data["functions"] = inja::json::array();
-		for (auto &[generator,f] : s.getFunctions())
+		if (include.first.empty())
 		{
-
-			inja::json function_data;
-			function_data["identifier"] = f.identifier;
-			function_data["return_type"] = convert_to_local_type(&ps, f.return_type);
-			function_data["static"] = f.static_function;
-			function_data["parameters"] = inja::json::array();
-			for (auto &p : f.parameters)
+			data["includes"].push_back(include.second);
+		}
+		else
+		{
+			if (data["generators"].find(include.first) == data["generators"].end())
 			{
-				inja::json parameter_data;
-				parameter_data["type"] = convert_to_local_type(&ps, p.first);
-				parameter_data["identifier"] = p.second;
+				data["generators"][include.first] = inja::json::object();
+				data["generators"][include.first]["includes"] = inja::json::array();
+			}
+			data["generators"][include.first]["includes"].push_back(include.second);
+		}
+	}
+
+	data["base_classes"] = inja::json::array();
+    for (auto &bc : base_classes)
+    {
+        if (bc.getIdentifier().empty())
+        {
+            continue;
+        }
+        inja::json base_class_data;
+        base_class_data["identifier"] = bc.getIdentifier();
+        base_class_data["formatted_include"] = format_include("Has" + bc.getIdentifier() + "Schema.hpp");
+        
+        // Add functions from base class
+        base_class_data["functions"] = inja::json::array();
+        for (auto & [generator, f] : bc.getFunctions())
+        {
+            inja::json function_data;
+            function_data["identifier"] = f.identifier;
+            function_data["return_type"] = convert_to_local_type(&ps, f.return_type);
+            function_data["static"] = f.static_function;
+            function_data["parameters"] = inja::json::array();
+            for (auto &p : f.parameters)
+            {
+                inja::json parameter_data;
+                parameter_data["type"] = convert_to_local_type(&ps, p.first);
+                parameter_data["identifier"] = p.second;
 				if (!p.first.is_defaulted())
 				{
 					parameter_data["defaultArg"] = false;
@@ -279,229 +299,210 @@ bool CppGenerator::generate_files(ProgramStructure ps, std::string out_path)
 				{
 					parameter_data["defaultArg"] = get_default_of_type(&ps, p.first);
 				}
-				function_data["parameters"].push_back(parameter_data);
-			}
-			function_data["can_generate_function"] = f.generate_function != nullptr;
-
-			// add the function to the data
+                function_data["parameters"].push_back(parameter_data);
+            }
+            function_data["can_generate_function"] = f.generate_function != nullptr;
 			if (f.generate_function)
 			{
+				// base classes are shared by every thread, call on a copy
+				FunctionDefinition fd = f;
 				std::stringstream ss;
-				f.generate_function(this, &ps, s, f, ss);
+				fd.generate_function(this, &ps, s, fd, ss);
 				function_data["generate_function"] = ss.str();
 			}
-			if (f.generator.empty())
-			{
-				data["functions"].push_back(function_data);
-			}
-			else
-			{
-				if (data["generators"].find(f.generator) == data["generators"].end())
-				{
-					data["generators"][f.generator] = inja::json::object();
-					data["generators"][f.generator]["functions"] = inja::json::array();
-				}
-
-				data["generators"][f.generator]["functions"].push_back(function_data);
-			}
-		}
-
-		data["includes"] = inja::json::array();
-		for (auto &include : s.getIncludes())
-		{
-			if (include.first.empty())
-			{
-				data["includes"].push_back(include.second);
-			}
-			else
-			{
-				if (data["generators"].find(include.first) == data["generators"].end())
-				{
-					data["generators"][include.first] = inja::json::object();
-					data["generators"][include.first]["includes"] = inja::json::array();
-				}
-				data["generators"][include.first]["includes"].push_back(include.second);
-			}
-		}
-
-		data["base_classes"] = inja::json::array();
-        for (auto &bc : base_classes)
-        {
-            if (bc.getIdentifier().empty())
-            {
-                continue;
-            }
-            inja::json base_class_data;
-            base_class_data["identifier"] = bc.getIdentifier();
-            base_class_data["formatted_include"] = format_include("Has" + bc.getIdentifier() + "Schema.hpp");
-            
-            // Add functions from base class
-            base_class_data["functions"] = inja::json::array();
-            for (auto & [generator, f] : bc.getFunctions())
-            {
-                inja::json function_data;
-                function_data["identifier"] = f.identifier;
-                function_data["return_type"] = convert_to_local_type(&ps, f.return_type);
-                function_data["static"] = f.static_function;
-                function_data["parameters"] = inja::json::array();
-                for (auto &p : f.parameters)
-                {
-                    inja::json parameter_data;
-                    parameter_data["type"] = convert_to_local_type(&ps, p.first);
-                    parameter_data["identifier"] = p.second;
-					if (!p.first.is_defaulted())
-					{
-						parameter_data["defaultArg"] = false;
-					}
-					else
-					{
-						parameter_data["defaultArg"] = get_default_of_type(&ps, p.first);
-					}
-                    function_data["parameters"].push_back(parameter_data);
-                }
-                function_data["can_generate_function"] = f.generate_function != nullptr;
-				if (f.generate_function)
-				{
-					std::stringstream ss;
-					f.generate_function(this, &ps, s, f, ss);
-					function_data["generate_function"] = ss.str();
-				}
-                function_data["is_override"] = true;
-                
-                base_class_data["functions"].push_back(function_data);
-            }
-            
-            // Add includes from base class
-            base_class_data["includes"] = inja::json::array();
-            for (auto &[generator,include] : bc.getIncludes())
-            {
-                base_class_data["includes"].push_back(include);
-            }
+            function_data["is_override"] = true;
             
-            data["base_classes"].push_back(base_class_data);
+            base_class_data["functions"].push_back(function_data);
         }
+        
+        // Add includes from base class
+        base_class_data["includes"] = inja::json::array();
+        for (auto &[generator,include] : bc.getIncludes())
+        {
+            base_class_data["includes"].push_back(include);
+        }
+        
+        data["base_classes"].push_back(base_class_data);
+    }
 
-		// Add schema includes for member variable types (deduplicated)
-		data["schema_includes"] = inja::json::array();
-		std::set<std::string> schema_includes_set;
-		for (auto& [generator, mv] : s.getMemberVariables())
-		{
-			// Include the header file for the member variable type if it is a struct or enum
-			if (ps.tokenIsStruct(mv.type.identifier()) || ps.tokenIsEnum(mv.type.identifier()))
-			{
-				schema_includes_set.insert(format_include(mv.type.identifier() + "Schema.hpp"));
-			}
-			if (mv.type.identifier() == ARRAY)
-			{
-				if (ps.tokenIsStruct(mv.type.element_type().identifier()) || ps.tokenIsEnum(mv.type.element_type().identifier()))
-				{
-					schema_includes_set.insert(format_include(mv.type.element_type().identifier() + "Schema.hpp"));
-				}
-			}
-		}
-		for (const auto &inc : schema_includes_set)
+	// Add schema includes for member variable types (deduplicated)
+	data["schema_includes"] = inja::json::array();
+	std::set<std::string> schema_includes_set;
+	for (auto& [generator, mv] : s.getMemberVariables())
+	{
+		// Include the header file for the member variable type if it is a struct or enum
+		if (mv.type.is_struct(&ps) || mv.type.is_enum(&ps))
 		{
-			data["schema_includes"].push_back(inc);
+			schema_includes_set.insert(format_include(mv.type.identifier() + "Schema.hpp"));
 		}
-
-		data["member_variables"] = inja::json::array();
-		for (auto& [generator, mv] : s.getMemberVariables())
+		if (mv.type.identifier() == ARRAY)
 		{
-			inja::json mv_data;
-			mv_data["identifier"] = mv.identifier;
-			mv_data["type"] = convert_to_local_type(&ps, mv.type);
-			mv_data["static"] = mv.static_member;
-			mv_data["required"] = mv.required;
-			if (mv.default_value.empty())
-			{
-				mv_data["default_value"] = false;
-			}
-			else
+			if (mv.type.element_type().is_struct(&ps) || mv.type.element_type().is_enum(&ps))
 			{
-				mv_data["default_value"] = mv.default_value;
+				schema_includes_set.insert(format_include(mv.type.element_type().identifier() + "Schema.hpp"));
 			}
-			data["member_variables"].push_back(mv_data);
-		}
-		data["private_variables"] = inja::json::array();
-		for (auto &[generator,pv] : s.getPrivateVariables())
-		{
-			inja::json pv_data;
-			pv_data["identifier"] = pv.identifier;
-			pv_data["type"] = convert_to_local_type(&ps, pv.type);
-			pv_data["static"] = pv.static_member;
-			pv_data["const"] = pv.const_member;
-			data["private_variables"].push_back(pv_data);
 		}
+	}
+	for (const auto &inc : schema_includes_set)
+	{
+		data["schema_includes"].push_back(inc);
+	}
 
-		//nested template data
-		data["before_setter_lines"] = inja::json::array();
-		for (auto &[generator,line] : s.getBeforeSetterLines())
+	data["member_variables"] = inja::json::array();
+	for (auto& [generator, mv] : s.getMemberVariables())
+	{
+		inja::json mv_data;
+		mv_data["identifier"] = mv.identifier;
+		mv_data["type"] = convert_to_local_type(&ps, mv.type);
+		mv_data["static"] = mv.static_member;
+		mv_data["required"] = mv.required;
+		if (mv.default_value.empty())
 		{
-			inja::json line_data;
-			line_data["line"] = env.render(line, data);
-			data["before_setter_lines"].push_back(line_data);
+			mv_data["default_value"] = false;
 		}
-		data["before_getter_lines"] = inja::json::array();
-		for (auto &[genrator,line] : s.getBeforeSetterLines())
+		else
 		{
-			inja::json line_data;
-			line_data["line"] = env.render(line, data);
-			data["before_getter_lines"].push_back(line_data);
+			mv_data["default_value"] = mv.default_value;
 		}
+		data["member_variables"].push_back(mv_data);
+	}
+	data["private_variables"] = inja::json::array();
+	for (auto &[generator,pv] : s.getPrivateVariables())
+	{
+		inja::json pv_data;
+		pv_data["identifier"] = pv.identifier;
+		pv_data["type"] = convert_to_local_type(&ps, pv.type);
+		pv_data["static"] = pv.static_member;
+		pv_data["const"] = pv.const_member;
+		data["private_variables"].push_back(pv_data);
+	}
+
+	//nested template data
+	data["before_setter_lines"] = inja::json::array();
+	for (auto &[generator,line] : s.getBeforeSetterLines())
+	{
+		inja::json line_data;
+		line_data["line"] = env.render(line, data);
+		data["before_setter_lines"].push_back(line_data);
+	}
+	data["before_getter_lines"] = inja::json::array();
+	for (auto &[genrator,line] : s.getBeforeSetterLines())
+	{
+		inja::json line_data;
+		line_data["line"] = env.render(line, data);
+		data["before_getter_lines"].push_back(line_data);
+	}
+
+	try
+	{
+		renderTemplates(env, templates, data, sink);
+	}
+	catch (const std::exception &e)
+	{
+		std::cout << "Error generating file for struct " << s.getIdentifier() << ": " << e.what() << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool CppGenerator::generate_enum_files(EnumDefinition &e, const std::vector<CompiledTemplate> &templates, OutputSink &sink)
+{
+	inja::Environment env;
+	env.set_trim_blocks(true);
+
+	inja::json data;
+	data["enum"] = e.identifier;
+	data["enum_include"] = format_include(e.identifier + "Schema.hpp");
+
+	data["values"] = inja::json::array();
+	for (auto &v : e.values)
+	{
+		inja::json value_data;
+		value_data["identifier"] = v.first;
+		value_data["value"] = v.second;
+		data["values"].push_back(value_data);
+	}
+
+	try
+	{
+		renderTemplates(env, templates, data, sink);
+	}
+	catch (const std::exception &ex)
+	{
+		std::cout << "Error generating file for enum " << e.identifier << ": " << ex.what() << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool CppGenerator::generate_files(ProgramStructure &ps, std::string out_path, OutputSink &sink)
+{
+	// generate the base class header files
+	std::vector<StructDefinition> base_classes;
+	ModelOverlay overlay(ps);
 
-		try
+	for (auto &gen : generators)
+	{
+		if (gen == this)
+		{          
+			continue;
+		}
+		if (!gen->base_class.getIdentifier().empty())
 		{
-			for (auto &file : struct_name_content_pairs)
+			if (!generate_base_class_header_file(gen, &ps, out_path, sink))
 			{
-				std::ofstream of(env.render(out_path + "/" + file.first, data));
-				if (!of.is_open())
-				{
-					std::cout << "Failed to open file: " << env.render(out_path + "/" + file.first, data);
-				}
-				of << env.render(file.second, data);
-				of.close();
-				std::cout << "Generated file: " << env.render(out_path + "/" + file.first, data) << std::endl;
+				std::cout << "Error: Failed to generate base class header file for " << gen->base_class.getIdentifier() << std::endl;
+				return false;
 			}
+			base_classes.push_back(gen->base_class);
 		}
-		catch (const std::exception &e)
+
+		for (size_t i = 0; i < overlay.size(); i++)
 		{
-			std::cout << "Error generating file for struct " << s.getIdentifier() << ": " << e.what() << std::endl;
-			return false;
+			if (!gen->add_generator_specific_content_to_struct(this, &ps, overlay.edit(i)))
+			{
+				std::cout << "Error: Failed to add Generator specific functions for " << gen->base_class.getIdentifier() << std::endl;
+				return false;
+			}
 		}
 	}
 
-	for (auto &e : ps.getEnums())
+	// every template and output path pattern is parsed once and shared by the workers
+	inja::Environment env;
+	env.set_trim_blocks(true);
+	// env.set_lstrip_blocks(true);
+	std::vector<CompiledTemplate> struct_templates;
+	std::vector<CompiledTemplate> enum_templates;
+	if (!compileTemplates(env, "/Cpp/struct/", out_path, struct_templates) || !compileTemplates(env, "/Cpp/enum/", out_path, enum_templates))
 	{
-		inja::json data;
-		data["enum"] = e.identifier;
-		data["enum_include"] = format_include(e.identifier + "Schema.hpp");
+		return false;
+	}
 
-		data["values"] = inja::json::array();
-		for (auto &v : e.values)
+	// structs and enums are rendered independently on up to jobs threads, each
+	// with its own inja environment. What they print is collected per item and
+	// printed in order afterwards, up to the first one that failed. A -watch
+	// rebuild skips the definitions that did not change.
+	size_t struct_count = overlay.size();
+	std::vector<EnumDefinition> &enums = ps.getEnums();
+	std::vector<std::string> messages(struct_count + enums.size());
+	std::vector<char> succeeded(messages.size(), false);
+	OutputCapture::install();
+	parallelFor(messages.size(), jobs, [&](size_t i)
+				{
+		OutputCapture capture(messages[i]);
+		if (i < struct_count)
 		{
-			inja::json value_data;
-			value_data["identifier"] = v.first;
-			value_data["value"] = v.second;
-			data["values"].push_back(value_data);
+			succeeded[i] = !ps.rendersDefinition(overlay.get(i).getIdentifier()) || generate_struct_files(ps, overlay.get(i), base_classes, struct_templates, sink);
 		}
-
-		try
+		else
 		{
-			for (auto &file : enum_name_content_pairs)
-			{
-				std::ofstream of(env.render(out_path + "/" + file.first, data));
-				if (!of.is_open())
-				{
-					std::cout << "Failed to open file: " << env.render(out_path + "/" + file.first, data);
-				}
-				of << env.render(file.second, data);
-				of.close();
-				std::cout << "Generated file: " << env.render(out_path + "/" + file.first, data) << std::endl;
-			}
-		}
-		catch (const std::exception &ex)
+			succeeded[i] = !ps.rendersDefinition(enums[i - struct_count].identifier) || generate_enum_files(enums[i - struct_count], enum_templates, sink);
+		} });
+	for (size_t i = 0; i < messages.size(); i++)
+	{
+		std::cout << messages[i];
+		if (!succeeded[i])
 		{
-			std::cout << "Error generating file for enum " << e.identifier << ": " << ex.what() << std::endl;
 			return false;
 		}
 	}
@@ -1,13 +1,8 @@
 #include <BuiltInGenerators/JavaGenerator.hpp>
 
-void JavaGenerator::generate_enum_file(EnumDefinition e, std::string out_path)
+void JavaGenerator::generate_enum_file(EnumDefinition e, std::string out_path, OutputSink &sink)
 {
-    std::ofstream enumFile(out_path + "/" + e.identifier + ".java");
-    if (!enumFile.is_open())
-    {
-        std::cout << "Failed to open file: " << out_path + "/" + e.identifier + ".java" << std::endl;
-        return;
-    }
+    GeneratedFile enumFile(sink, out_path + "/" + e.identifier + ".java");
     
     enumFile << "public enum " << e.identifier << " {\n";
     
@@ -56,14 +51,9 @@ void JavaGenerator::generate_enum_file(EnumDefinition e, std::string out_path)
     enumFile.close();
 }
 
-void JavaGenerator::generate_struct_file(StructDefinition s, ProgramStructure *ps, std::string out_path, std::vector<StructDefinition> base_classes)
+void JavaGenerator::generate_struct_file(StructDefinition s, ProgramStructure *ps, std::string out_path, OutputSink &sink, std::vector<StructDefinition> base_classes)
 {
-    std::ofstream structFile(out_path + "/" + s.getIdentifier() + ".java");
-    if (!structFile.is_open())
-    {
-        std::cout << "Failed to open file: " << out_path + "/" + s.getIdentifier() + ".java" << std::endl;
-        return;
-    }
+    GeneratedFile structFile(sink, out_path + "/" + s.getIdentifier() + ".java");
     
     // Imports
     structFile << "import java.util.*;\n";
@@ -161,7 +151,7 @@ void JavaGenerator::generate_struct_file(StructDefinition s, ProgramStructure *p
     structFile.close();
 }
 
-void JavaGenerator::generate_member_variable_getter(MemberVariableDefinition &mv, ProgramStructure *ps, std::ofstream &structFile)
+void JavaGenerator::generate_member_variable_getter(MemberVariableDefinition &mv, ProgramStructure *ps, std::ostream &structFile)
 {
     std::string methodName = "get" + mv.identifier;
     methodName[3] = std::toupper(methodName[3]); // Capitalize first letter after "get"
@@ -171,7 +161,7 @@ void JavaGenerator::generate_member_variable_getter(MemberVariableDefinition &mv
     structFile << "    }\n\n";
 }
 
-void JavaGenerator::generate_member_variable_setter(MemberVariableDefinition &mv, ProgramStructure *ps, std::ofstream &structFile)
+void JavaGenerator::generate_member_variable_setter(MemberVariableDefinition &mv, ProgramStructure *ps, std::ostream &structFile)
 {
     std::string methodName = "set" + mv.identifier;
     methodName[3] = std::toupper(methodName[3]); // Capitalize first letter after "set"
@@ -181,7 +171,7 @@ void JavaGenerator::generate_member_variable_setter(MemberVariableDefinition &mv
     structFile << "    }\n\n";
 }
 
-void JavaGenerator::generate_constructor(StructDefinition &s, ProgramStructure *ps, std::ofstream &structFile)
+void JavaGenerator::generate_constructor(StructDefinition &s, ProgramStructure *ps, std::ostream &structFile)
 {
     structFile << "    public " << s.getIdentifier() << "(";
     
@@ -204,7 +194,7 @@ void JavaGenerator::generate_constructor(StructDefinition &s, ProgramStructure *
     structFile << "    }\n\n";
 }
 
-void JavaGenerator::generate_to_string_method(StructDefinition &s, ProgramStructure *ps, std::ofstream &structFile)
+void JavaGenerator::generate_to_string_method(StructDefinition &s, ProgramStructure *ps, std::ostream &structFile)
 {
     structFile << "    @Override\n";
     structFile << "    public String toString() {\n";
@@ -227,7 +217,7 @@ void JavaGenerator::generate_to_string_method(StructDefinition &s, ProgramStruct
     structFile << "    }\n\n";
 }
 
-void JavaGenerator::generate_equals_method(StructDefinition &s, ProgramStructure *ps, std::ofstream &structFile)
+void JavaGenerator::generate_equals_method(StructDefinition &s, ProgramStructure *ps, std::ostream &structFile)
 {
     structFile << "    @Override\n";
     structFile << "    public boolean equals(Object obj) {\n";
@@ -258,7 +248,7 @@ void JavaGenerator::generate_equals_method(StructDefinition &s, ProgramStructure
     structFile << "    }\n\n";
 }
 
-void JavaGenerator::generate_hash_code_method(StructDefinition &s, ProgramStructure *ps, std::ofstream &structFile)
+void JavaGenerator::generate_hash_code_method(StructDefinition &s, ProgramStructure *ps, std::ostream &structFile)
 {
     structFile << "    @Override\n";
     structFile << "    public int hashCode() {\n";
@@ -277,7 +267,7 @@ void JavaGenerator::generate_hash_code_method(StructDefinition &s, ProgramStruct
     structFile << "    }\n\n";
 }
 
-void JavaGenerator::generate_generator_methods(StructDefinition &s, ProgramStructure *ps, std::vector<StructDefinition> &base_classes, std::ofstream &structFile)
+void JavaGenerator::generate_generator_methods(StructDefinition &s, ProgramStructure *ps, std::vector<StructDefinition> &base_classes, std::ostream &structFile)
 {
     // Generate methods from other generators
     for (auto &bc : base_classes)
@@ -448,13 +438,13 @@ std::string JavaGenerator::get_java_type(TypeDefinition type, ProgramStructure *
     }
     
     // Check if it's an enum
-    if (ps->tokenIsEnum(type.identifier()))
+    if (type.is_enum(ps))
     {
         return type.identifier();
     }
     
     // Check if it's a struct
-    if (ps->tokenIsStruct(type.identifier()))
+    if (type.is_struct(ps))
     {
         return type.identifier();
     }
@@ -499,7 +489,7 @@ std::string JavaGenerator::get_java_default_value(TypeDefinition type, ProgramSt
     }
     
     // Check if it's an enum - use first value
-    if (ps->tokenIsEnum(type.identifier()))
+    if (type.is_enum(ps))
     {
         EnumDefinition e = ps->getEnum(type.identifier());
         if (!e.values.empty())
@@ -510,7 +500,7 @@ std::string JavaGenerator::get_java_default_value(TypeDefinition type, ProgramSt
     }
     
     // Check if it's a struct
-    if (ps->tokenIsStruct(type.identifier()))
+    if (type.is_struct(ps))
     {
         return "new " + type.identifier() + "()";
     }
@@ -527,7 +517,7 @@ JavaGenerator::JavaGenerator()
     FunctionDefinition validate;
     validate.generator = "Java";
     validate.identifier = "validate";
-    validate.return_type.identifier() = "boolean";
+    validate.return_type.setIdentifier("boolean");
     validate.generate_function = [](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
     {
         structFile << "        // Validate required fields\n";
@@ -557,7 +547,7 @@ JavaGenerator::JavaGenerator()
     FunctionDefinition clone;
     clone.generator = "Java";
     clone.identifier = "clone";
-    clone.return_type.identifier() = "Object";
+    clone.return_type.setIdentifier("Object");
     clone.generate_function = [](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
     {
         structFile << "        " << s.getIdentifier() << " cloned = new " << s.getIdentifier() << "();\n";
@@ -584,7 +574,7 @@ JavaGenerator::JavaGenerator()
     FunctionDefinition toJson;
     toJson.generator = "Java";
     toJson.identifier = "toJson";
-    toJson.return_type.identifier() = "String";
+    toJson.return_type.setIdentifier("String");
     toJson.generate_function = [](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
     {
         structFile << "        // Convert to JSON using Jackson ObjectMapper\n";
@@ -600,7 +590,7 @@ JavaGenerator::JavaGenerator()
     FunctionDefinition fromJson;
     fromJson.generator = "Java";
     fromJson.identifier = "fromJson";
-    fromJson.return_type.identifier() = "Object"; // Will be corrected in generation
+    fromJson.return_type.setIdentifier("Object"); // Will be corrected in generation
     fromJson.static_function = true;
     fromJson.parameters.push_back(std::make_pair(TypeDefinition("String"), "json"));
     fromJson.generate_function = [](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
@@ -619,7 +609,7 @@ JavaGenerator::JavaGenerator()
     FunctionDefinition saveToDatabase;
     saveToDatabase.generator = "Java";
     saveToDatabase.identifier = "saveToDatabase";
-    saveToDatabase.return_type.identifier() = "void";
+    saveToDatabase.return_type.setIdentifier("void");
     saveToDatabase.parameters.push_back(std::make_pair(TypeDefinition("Connection"), "connection"));
     saveToDatabase.generate_function = [](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
     {
@@ -665,7 +655,7 @@ JavaGenerator::JavaGenerator()
     FunctionDefinition loadFromDatabase;
     loadFromDatabase.generator = "Java";
     loadFromDatabase.identifier = "loadFromDatabase";
-    loadFromDatabase.return_type.identifier() = "Object"; // Will be corrected in generation
+    loadFromDatabase.return_type.setIdentifier("Object"); // Will be corrected in generation
     loadFromDatabase.static_function = true;
     loadFromDatabase.parameters.push_back(std::make_pair(TypeDefinition("Connection"), "connection"));
     loadFromDatabase.parameters.push_back(std::make_pair(TypeDefinition("Object"), "id"));
@@ -718,7 +708,7 @@ JavaGenerator::JavaGenerator()
     FunctionDefinition toLuaTable;
     toLuaTable.generator = "Java";
     toLuaTable.identifier = "toLuaTable";
-    toLuaTable.return_type.identifier() = "String";
+    toLuaTable.return_type.setIdentifier("String");
     toLuaTable.generate_function = [](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
     {
         structFile << "        // Convert to Lua table format using LuaJ\n";
@@ -773,7 +763,7 @@ JavaGenerator::JavaGenerator()
     FunctionDefinition fromLuaTable;
     fromLuaTable.generator = "Java";
     fromLuaTable.identifier = "fromLuaTable";
-    fromLuaTable.return_type.identifier() = "Object"; // Will be corrected in generation
+    fromLuaTable.return_type.setIdentifier("Object"); // Will be corrected in generation
     fromLuaTable.static_function = true;
     fromLuaTable.parameters.push_back(std::make_pair(TypeDefinition("LuaValue"), "luaTable"));
     fromLuaTable.generate_function = [](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
@@ -848,7 +838,7 @@ JavaGenerator::JavaGenerator()
     FunctionDefinition to_cpp_object;
     to_cpp_object.generator = "Java";
     to_cpp_object.identifier = "to_cpp_object";
-    to_cpp_object.return_type.identifier() = "jobject";
+    to_cpp_object.return_type.setIdentifier("jobject");
     to_cpp_object.parameters.push_back(std::make_pair(TypeDefinition("JNIEnv*"), "env"));
     to_cpp_object.parameters.push_back(std::make_pair(TypeDefinition("jclass"), "java_class"));
     to_cpp_object.generate_function = [](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
@@ -911,7 +901,7 @@ JavaGenerator::JavaGenerator()
     FunctionDefinition from_cpp_object;
     from_cpp_object.generator = "Java";
     from_cpp_object.identifier = "from_cpp_object";
-    from_cpp_object.return_type.identifier() = "void";
+    from_cpp_object.return_type.setIdentifier("void");
     from_cpp_object.parameters.push_back(std::make_pair(TypeDefinition("JNIEnv*"), "env"));
     from_cpp_object.parameters.push_back(std::make_pair(TypeDefinition("jobject"), "java_obj"));
     from_cpp_object.generate_function = [](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
@@ -981,7 +971,7 @@ JavaGenerator::JavaGenerator()
     FunctionDefinition create_jni_bridge;
     create_jni_bridge.generator = "Java";
     create_jni_bridge.identifier = "create_jni_bridge";
-    create_jni_bridge.return_type.identifier() = "std::string";
+    create_jni_bridge.return_type.setIdentifier("std::string");
     create_jni_bridge.static_function = true;
     create_jni_bridge.generate_function = [](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
     {
@@ -1034,15 +1024,11 @@ bool JavaGenerator::add_generator_specific_content_to_struct(Generator *gen, Pro
     return true;
 }
 
-bool JavaGenerator::generate_files(ProgramStructure ps, std::string out_path)
+bool JavaGenerator::generate_files(ProgramStructure &ps, std::string out_path, OutputSink &sink)
 {
-    if (!std::filesystem::exists(out_path))
-    {
-        std::filesystem::create_directories(out_path);
-    }
-    
     // Collect base classes from other generators
     std::vector<StructDefinition> base_classes;
+    ModelOverlay overlay(ps);
     for (auto &gen : generators)
     {
         if (gen == this) continue;
@@ -1051,50 +1037,53 @@ bool JavaGenerator::generate_files(ProgramStructure ps, std::string out_path)
             base_classes.push_back(gen->base_class);
             
             // Generate interface files for Java
-            std::ofstream interfaceFile(out_path + "/Has" + gen->base_class.getIdentifier() + ".java");
-            if (interfaceFile.is_open())
+            GeneratedFile interfaceFile(sink, out_path + "/Has" + gen->base_class.getIdentifier() + ".java");
+            interfaceFile << "import java.util.*;\n\n";
+            interfaceFile << "public interface Has" << gen->base_class.getIdentifier() << " {\n";
+            
+            for (auto & [generator, f] : gen->base_class.getFunctions())
             {
-                interfaceFile << "import java.util.*;\n\n";
-                interfaceFile << "public interface Has" << gen->base_class.getIdentifier() << " {\n";
+                interfaceFile << "    " << convert_to_local_type(&ps, f.return_type) << " " << f.identifier << "(";
                 
-                for (auto & [generator, f] : gen->base_class.getFunctions())
+                for (size_t i = 0; i < f.parameters.size(); i++)
                 {
-                    interfaceFile << "    " << convert_to_local_type(&ps, f.return_type) << " " << f.identifier << "(";
-                    
-                    for (size_t i = 0; i < f.parameters.size(); i++)
+                    interfaceFile << convert_to_local_type(&ps, f.parameters[i].first) << " " << f.parameters[i].second;
+                    if (i < f.parameters.size() - 1)
                     {
-                        interfaceFile << convert_to_local_type(&ps, f.parameters[i].first) << " " << f.parameters[i].second;
-                        if (i < f.parameters.size() - 1)
-                        {
-                            interfaceFile << ", ";
-                        }
+                        interfaceFile << ", ";
                     }
-                    
-                    interfaceFile << ");\n";
                 }
                 
-                interfaceFile << "}\n";
-                interfaceFile.close();
+                interfaceFile << ");\n";
             }
+            
+            interfaceFile << "}\n";
+            interfaceFile.close();
         }
         
         // Allow other generators to add content to structs
-        for (auto &s : ps.getStructs())
+        for (size_t i = 0; i < overlay.size(); i++)
         {
-            gen->add_generator_specific_content_to_struct(this, &ps, s);
+            gen->add_generator_specific_content_to_struct(this, &ps, overlay.edit(i));
         }
     }
     
     // Generate enum files
     for (auto &e : ps.getEnums())
     {
-        generate_enum_file(e, out_path);
+        if (ps.rendersDefinition(e.identifier))
+        {
+            generate_enum_file(e, out_path, sink);
+        }
     }
     
     // Generate struct files with base classes
-    for (auto &s : ps.getStructs())
+    for (size_t i = 0; i < overlay.size(); i++)
     {
-        generate_struct_file(s, &ps, out_path, base_classes);
+        if (ps.rendersDefinition(overlay.get(i).getIdentifier()))
+        {
+            generate_struct_file(overlay.get(i), &ps, out_path, sink, base_classes);
+        }
     }
     
     return true;
@@ -50,11 +50,11 @@ json JsonGenerator::structToSchema(StructDefinition s, ProgramStructure *ps)
 			{
 				json array_property;
 				array_property["type"] = "array";
-				if (ps->tokenIsStruct(mv.type.element_type().identifier()))
+				if (mv.type.element_type().is_struct(ps))
 				{
 					array_property["items"] = structToSchema(ps->getStruct(mv.type.element_type().identifier()), ps);
 				}
-				else if (ps->tokenIsEnum(mv.type.element_type().identifier()))
+				else if (mv.type.element_type().is_enum(ps))
 				{
 					array_property["items"] = enumToSchema(ps->getEnum(mv.type.element_type().identifier()));
 				}
@@ -109,7 +109,7 @@ json JsonGenerator::structToSchema(StructDefinition s, ProgramStructure *ps)
 	}
 	catch (const std::exception &e)
 	{
-		printf("Error generating schema for struct %s: %s\n", s.getIdentifier().c_str(), e.what());
+		std::cout << "Error generating schema for struct " << s.getIdentifier() << ": " << e.what() << std::endl;
 		exit(1);
 	}
 	return j;
@@ -122,7 +122,7 @@ JsonGenerator::JsonGenerator()
 	FunctionDefinition toJSON;
 	toJSON.generator = name;
 	toJSON.identifier = "toJSON";
-	toJSON.return_type.identifier() = "nlohmann::json";
+	toJSON.return_type.setIdentifier("nlohmann::json");
 	toJSON.generate_function = [](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
 	{
 		structFile << "\tnlohmann::json j;\n";
@@ -160,11 +160,11 @@ JsonGenerator::JsonGenerator()
 				{
 					structFile << "\tnlohmann::json " << mv.identifier << "Array;\n";
 					structFile << "\tfor(auto &v : " << mv.identifier << "){\n";
-					if (ps->tokenIsStruct(mv.type.element_type().identifier()))
+					if (mv.type.element_type().is_struct(ps))
 					{
 						structFile << "\t\t" << mv.identifier << "Array.push_back(v->toJSON());\n";
 					}
-					else if (ps->tokenIsEnum(mv.type.element_type().identifier()))
+					else if (mv.type.element_type().is_enum(ps))
 					{
 						structFile << "\t\t" << mv.identifier << "Array.push_back(v);\n";
 					}
@@ -180,11 +180,11 @@ JsonGenerator::JsonGenerator()
 					structFile << "\tif (" << mv.identifier << ".has_value()) {\n";
 					structFile << "\t\tnlohmann::json " << mv.identifier << "Array;\n";
 					structFile << "\t\tfor(auto &v : " << mv.identifier << ".value()){\n";
-					if (ps->tokenIsStruct(mv.type.element_type().identifier()))
+					if (mv.type.element_type().is_struct(ps))
 					{
 						structFile << "\t\t\t" << mv.identifier << "Array.push_back(v->toJSON());\n";
 					}
-					else if (ps->tokenIsEnum(mv.type.element_type().identifier()))
+					else if (mv.type.element_type().is_enum(ps))
 					{
 						structFile << "\t\t\t" << mv.identifier << "Array.push_back(v);\n";
 					}
@@ -217,7 +217,7 @@ JsonGenerator::JsonGenerator()
 	FunctionDefinition fromJSON;
 	fromJSON.generator = name;
 	fromJSON.identifier = "fromJSON";
-	fromJSON.return_type.identifier() = "void";
+	fromJSON.return_type.setIdentifier("void");
 	fromJSON.parameters.push_back(std::make_pair(TypeDefinition("nlohmann::json"), "j"));
 	fromJSON.generate_function = [](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
 	{
@@ -265,13 +265,13 @@ JsonGenerator::JsonGenerator()
 				{
 					structFile << "\t\t" << mv.identifier << ".clear();\n";
 					structFile << "\t\tfor(auto &v : j[\"" << mv.identifier << "\"]){\n";
-					if (ps->tokenIsStruct(mv.type.element_type().identifier()))
+					if (mv.type.element_type().is_struct(ps))
 					{
 						structFile << "\t\t\t" << mv.type.element_type().identifier() << "Schema *new_" << mv.type.element_type().identifier() << " = new " << mv.type.element_type().identifier() << "Schema();\n";
 						structFile << "\t\t\tnew_" << mv.type.element_type().identifier() << "->fromJSON(v);\n";
 						structFile << "\t\t\t" << mv.identifier << ".push_back(new_" << mv.type.element_type().identifier() << ");\n";
 					}
-					else if (ps->tokenIsEnum(mv.type.element_type().identifier()))
+					else if (mv.type.element_type().is_enum(ps))
 					{
 						structFile << "\t\t\t" << gen->convert_to_local_type(ps, mv.type.element_type()) << " new_" << mv.type.element_type().identifier() << " = v;\n";
 						structFile << "\t\t\t" << mv.identifier << ".push_back(new_" << mv.type.element_type().identifier() << ");\n";
@@ -287,13 +287,13 @@ JsonGenerator::JsonGenerator()
 				{
 					structFile << "\t\t" << gen->convert_to_local_type(ps, mv.type) << " temp_" << mv.identifier << ";\n";
 					structFile << "\t\tfor(auto &v : j[\"" << mv.identifier << "\"]){\n";
-					if (ps->tokenIsStruct(mv.type.element_type().identifier()))
+					if (mv.type.element_type().is_struct(ps))
 					{
 						structFile << "\t\t\t" << mv.type.element_type().identifier() << "Schema *new_" << mv.type.element_type().identifier() << " = new " << mv.type.element_type().identifier() << "Schema();\n";
 						structFile << "\t\t\tnew_" << mv.type.element_type().identifier() << "->fromJSON(v);\n";
 						structFile << "\t\t\ttemp_" << mv.identifier << ".push_back(new_" << mv.type.element_type().identifier() << ");\n";
 					}
-					else if (ps->tokenIsEnum(mv.type.element_type().identifier()))
+					else if (mv.type.element_type().is_enum(ps))
 					{
 						structFile << "\t\t\t" << gen->convert_to_local_type(ps, mv.type.element_type()) << " new_" << mv.type.element_type().identifier() << " = v;\n";
 						structFile << "\t\t\ttemp_" << mv.identifier << ".push_back(new_" << mv.type.element_type().identifier() << ");\n";
@@ -327,7 +327,7 @@ JsonGenerator::JsonGenerator()
 	FunctionDefinition getSchema;
 	getSchema.generator = name;
 	getSchema.identifier = "getSchema";
-	getSchema.return_type.identifier() = "nlohmann::json";
+	getSchema.return_type.setIdentifier("nlohmann::json");
 	getSchema.generate_function = [this](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
 	{
 		structFile << "\treturn nlohmann::json::parse(\n";
@@ -381,23 +381,17 @@ bool JsonGenerator::add_generator_specific_content_to_struct(Generator *gen, Pro
 	return true;
 }
 
-bool JsonGenerator::generate_files(ProgramStructure ps, std::string out_path)
+bool JsonGenerator::generate_files(ProgramStructure &ps, std::string out_path, OutputSink &sink)
 {
-	if (!std::filesystem::exists(out_path))
-	{
-		std::filesystem::create_directories(out_path);
-	}
-
 	for (auto &s : ps.getStructs())
 	{
-		json j = structToSchema(s, &ps);
-
-		std::ofstream schemaFile(out_path + "/" + s.getIdentifier() + ".schema.json");
-		if (!schemaFile.is_open())
+		if (!ps.rendersDefinition(s.getIdentifier()))
 		{
-			std::cout << "Failed to open file: " << out_path + "/" + s.getIdentifier() + ".schema.json" << std::endl;
-			return false;
+			continue;
 		}
+		json j = structToSchema(s, &ps);
+
+		GeneratedFile schemaFile(sink, out_path + "/" + s.getIdentifier() + ".schema.json");
 		schemaFile << j.dump(4);
 		schemaFile.close();
 	}
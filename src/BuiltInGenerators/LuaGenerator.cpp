@@ -9,7 +9,7 @@ LuaGenerator::LuaGenerator()
 	FunctionDefinition lua_push;
 	lua_push.generator = "Lua";
 	lua_push.identifier = "lua_push";
-	lua_push.return_type.identifier() = "void";
+	lua_push.return_type.setIdentifier("void");
 	lua_push.parameters.push_back(std::make_pair(TypeDefinition("lua_State*"), "L"));
 	lua_push.generate_function = [](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
 	{
@@ -99,7 +99,7 @@ LuaGenerator::LuaGenerator()
 	FunctionDefinition lua_to;
 	lua_to.generator = "Lua";
 	lua_to.identifier = "lua_to";
-	lua_to.return_type.identifier() = "void";
+	lua_to.return_type.setIdentifier("void");
 	lua_to.parameters.push_back(std::make_pair(TypeDefinition("lua_State*"), "L"));
 	lua_to.parameters.push_back(std::make_pair(TypeDefinition("int"), "index"));
 	lua_to.generate_function = [](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
@@ -221,7 +221,7 @@ LuaGenerator::LuaGenerator()
 	FunctionDefinition lua_create_table;
 	lua_create_table.generator = "Lua";
 	lua_create_table.identifier = "lua_create_table";
-	lua_create_table.return_type.identifier() = "void";
+	lua_create_table.return_type.setIdentifier("void");
 	lua_create_table.static_function = true;
 	lua_create_table.parameters.push_back(std::make_pair(TypeDefinition("lua_State*"), "L"));
 	lua_create_table.parameters.push_back(std::make_pair(TypeDefinition("const std::string&"), "schema_name"));
@@ -423,7 +423,7 @@ std::string LuaGenerator::generate_lua_enum_table(EnumDefinition &e)
 	return lua_code;
 }
 
-void LuaGenerator::generate_lua_field(ProgramStructure *ps, MemberVariableDefinition &mv, std::ofstream &luaFile, int indent)
+void LuaGenerator::generate_lua_field(ProgramStructure *ps, MemberVariableDefinition &mv, std::ostream &luaFile, int indent)
 {
 	std::string ind = indent_string(indent);
 	luaFile << ind << mv.identifier << " = " << get_lua_default_value(ps, mv.type) << ", -- " << lua_type_comment(ps, mv.type);
@@ -436,7 +436,7 @@ void LuaGenerator::generate_lua_field(ProgramStructure *ps, MemberVariableDefini
 	luaFile << "\n";
 }
 
-void LuaGenerator::generate_lua_constructor(ProgramStructure *ps, StructDefinition &s, std::ofstream &luaFile)
+void LuaGenerator::generate_lua_constructor(ProgramStructure *ps, StructDefinition &s, std::ostream &luaFile)
 {
 	luaFile << "function " << s.getIdentifier() << ".new(data)\n";
 	luaFile << "  local instance = {\n";
@@ -471,7 +471,7 @@ void LuaGenerator::generate_lua_constructor(ProgramStructure *ps, StructDefiniti
 	luaFile << "end\n\n";
 }
 
-void LuaGenerator::generate_lua_tostring(ProgramStructure *ps, StructDefinition &s, std::ofstream &luaFile)
+void LuaGenerator::generate_lua_tostring(ProgramStructure *ps, StructDefinition &s, std::ostream &luaFile)
 {
 	luaFile << "function " << s.getIdentifier() << ":__tostring()\n";
 	luaFile << "  local result = \"" << s.getIdentifier() << " {\\n\"\n";
@@ -498,7 +498,7 @@ void LuaGenerator::generate_lua_tostring(ProgramStructure *ps, StructDefinition
 	luaFile << "end\n\n";
 }
 
-void LuaGenerator::generate_lua_validate(ProgramStructure *ps, StructDefinition &s, std::ofstream &luaFile)
+void LuaGenerator::generate_lua_validate(ProgramStructure *ps, StructDefinition &s, std::ostream &luaFile)
 {
 	luaFile << "function " << s.getIdentifier() << ":validate()\n";
 	luaFile << "  local errors = {}\n\n";
@@ -560,14 +560,9 @@ std::string LuaGenerator::generate_lua_table_struct(ProgramStructure *ps, Struct
 	return lua_code;
 }
 
-bool LuaGenerator::generate_struct_lua_file(ProgramStructure *ps, StructDefinition &s, std::string out_path, std::vector<StructDefinition> base_classes)
+bool LuaGenerator::generate_struct_lua_file(ProgramStructure *ps, StructDefinition &s, std::string out_path, OutputSink &sink, std::vector<StructDefinition> base_classes)
 {
-	std::ofstream luaFile(out_path + "/" + s.getIdentifier() + ".lua");
-	if (!luaFile.is_open())
-	{
-		std::cout << "Failed to open file: " << out_path + "/" + s.getIdentifier() + ".lua" << std::endl;
-		return false;
-	}
+	GeneratedFile luaFile(sink, out_path + "/" + s.getIdentifier() + ".lua");
 	
 	// File header
 	luaFile << "-- " << s.getIdentifier() << " Schema\n";
@@ -619,14 +614,9 @@ bool LuaGenerator::generate_struct_lua_file(ProgramStructure *ps, StructDefiniti
 	return true;
 }
 
-bool LuaGenerator::generate_enum_lua_file(EnumDefinition &e, std::string out_path)
+bool LuaGenerator::generate_enum_lua_file(EnumDefinition &e, std::string out_path, OutputSink &sink)
 {
-	std::ofstream luaFile(out_path + "/" + e.identifier + ".lua");
-	if (!luaFile.is_open())
-	{
-		std::cout << "Failed to open file: " << out_path + "/" + e.identifier + ".lua" << std::endl;
-		return false;
-	}
+	GeneratedFile luaFile(sink, out_path + "/" + e.identifier + ".lua");
 	
 	// File header
 	luaFile << "-- " << e.identifier << " Enum\n";
@@ -642,14 +632,9 @@ bool LuaGenerator::generate_enum_lua_file(EnumDefinition &e, std::string out_pat
 	return true;
 }
 
-bool LuaGenerator::generate_main_lua_file(ProgramStructure &ps, std::string out_path)
+bool LuaGenerator::generate_main_lua_file(ProgramStructure &ps, std::string out_path, OutputSink &sink)
 {
-	std::ofstream luaFile(out_path + "/schema.lua");
-	if (!luaFile.is_open())
-	{
-		std::cout << "Failed to open file: " << out_path + "/schema.lua" << std::endl;
-		return false;
-	}
+	GeneratedFile luaFile(sink, out_path + "/schema.lua");
 	
 	// File header
 	luaFile << "-- Main Schema Module\n";
@@ -700,7 +685,7 @@ bool LuaGenerator::generate_main_lua_file(ProgramStructure &ps, std::string out_
 	return true;
 }
 
-void LuaGenerator::generate_generator_methods(ProgramStructure *ps, StructDefinition &s, std::vector<StructDefinition> &base_classes, std::ofstream &luaFile)
+void LuaGenerator::generate_generator_methods(ProgramStructure *ps, StructDefinition &s, std::vector<StructDefinition> &base_classes, std::ostream &luaFile)
 {
 	// Generate methods from other generators
 	for (auto &bc : base_classes)
@@ -1028,15 +1013,11 @@ bool LuaGenerator::add_generator_specific_content_to_struct(Generator *gen, Prog
 	return true;
 }
 
-bool LuaGenerator::generate_files(ProgramStructure ps, std::string out_path)
+bool LuaGenerator::generate_files(ProgramStructure &ps, std::string out_path, OutputSink &sink)
 {
-	if (!std::filesystem::exists(out_path))
-	{
-		std::filesystem::create_directories(out_path);
-	}
-	
 	// Collect base classes from other generators
 	std::vector<StructDefinition> base_classes;
+	ModelOverlay overlay(ps);
 	for (auto &gen : generators)
 	{
 		if (gen == this) continue;
@@ -1046,16 +1027,16 @@ bool LuaGenerator::generate_files(ProgramStructure ps, std::string out_path)
 		}
 		
 		// Allow other generators to add content to structs
-		for (auto &s : ps.getStructs())
+		for (size_t i = 0; i < overlay.size(); i++)
 		{
-			gen->add_generator_specific_content_to_struct(this, &ps, s);
+			gen->add_generator_specific_content_to_struct(this, &ps, overlay.edit(i));
 		}
 	}
 	
 	// Generate enum files
 	for (auto &e : ps.getEnums())
 	{
-		if (!generate_enum_lua_file(e, out_path))
+		if (ps.rendersDefinition(e.identifier) && !generate_enum_lua_file(e, out_path, sink))
 		{
 			std::cout << "Failed to generate Lua file for enum: " << e.identifier << std::endl;
 			return false;
@@ -1063,9 +1044,10 @@ bool LuaGenerator::generate_files(ProgramStructure ps, std::string out_path)
 	}
 	
 	// Generate struct files with base classes
-	for (auto &s : ps.getStructs())
+	for (size_t i = 0; i < overlay.size(); i++)
 	{
-		if (!generate_struct_lua_file(&ps, s, out_path, base_classes))
+		StructDefinition &s = overlay.get(i);
+		if (ps.rendersDefinition(s.getIdentifier()) && !generate_struct_lua_file(&ps, s, out_path, sink, base_classes))
 		{
 			std::cout << "Failed to generate Lua file for struct: " << s.getIdentifier() << std::endl;
 			return false;
@@ -1073,7 +1055,7 @@ bool LuaGenerator::generate_files(ProgramStructure ps, std::string out_path)
 	}
 	
 	// Generate main aggregator file
-	if (!generate_main_lua_file(ps, out_path))
+	if (!generate_main_lua_file(ps, out_path, sink))
 	{
 		std::cout << "Failed to generate main Lua schema file" << std::endl;
 		return false;
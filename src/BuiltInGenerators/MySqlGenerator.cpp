@@ -102,11 +102,12 @@ std::string MysqlGenerator::generate_create_table_statement_string_struct(Progra
 }
 
 // Function to add foreign key columns for array relationships
-void MysqlGenerator::add_foreign_key_columns_for_arrays(ProgramStructure *ps)
+void MysqlGenerator::add_foreign_key_columns_for_arrays(ProgramStructure *ps, ModelOverlay &overlay)
 {
 	// Iterate through all structs
-	for (auto &parent_struct : ps->getStructs())
+	for (size_t i = 0; i < overlay.size(); i++)
 	{
+		StructDefinition &parent_struct = overlay.get(i);
 		// Look for array fields in this struct
 		for (auto & [generator, member_var] : parent_struct.getMemberVariables())
 		{
@@ -121,38 +122,27 @@ void MysqlGenerator::add_foreign_key_columns_for_arrays(ProgramStructure *ps)
 					// Find the target struct
 					std::string target_struct_name = element_type.identifier();
 					
-					// Find the target struct in the program structure
-					for (auto &target_struct : ps->getStructs())
+					// Find the target struct, the column goes into this generator's copy of it
+					StructDefinition *target = overlay.edit(target_struct_name);
+					if (target == nullptr)
 					{
-						if (target_struct.getIdentifier() == target_struct_name)
-						{
-							// Add foreign key column to the target struct
-							MemberVariableDefinition reference_column;
-							reference_column.identifier = parent_struct.getIdentifier() + "Id";
-							reference_column.type = TypeDefinition("int64");
-							reference_column.required = member_var.required; // If array is required, reference is NOT NULL
-							reference_column.reference.struct_name = parent_struct.getIdentifier();
-							reference_column.reference.variable_name = "id"; // Assuming parent has 'id' as primary key
-							reference_column.description = "Foreign key reference to " + parent_struct.getIdentifier() + " table";
-							
-							// Check if this foreign key column already exists
-							bool reference_exists = false;
-							for (auto &[generator,existing_var] : target_struct.getMemberVariables())
-							{
-								if (existing_var.identifier == reference_column.identifier)
-								{
-									reference_exists = true;
-									break;
-								}
-							}
-							
-							// Only add if it doesn't already exist
-							if (!reference_exists)
-							{
-								target_struct.add_member_variable(reference_column);
-							}
-							break;
-						}
+						continue;
+					}
+					StructDefinition &target_struct = *target;
+
+					// Add foreign key column to the target struct
+					MemberVariableDefinition reference_column;
+					reference_column.identifier = parent_struct.getIdentifier() + "Id";
+					reference_column.type = TypeDefinition("int64");
+					reference_column.required = member_var.required; // If array is required, reference is NOT NULL
+					reference_column.reference.struct_name = parent_struct.getIdentifier();
+					reference_column.reference.variable_name = "id"; // Assuming parent has 'id' as primary key
+					reference_column.description = "Foreign key reference to " + parent_struct.getIdentifier() + " table";
+					
+					// Only add if this foreign key column doesn't already exist
+					if (!target_struct.has_member_variable(reference_column.identifier))
+					{
+						target_struct.add_member_variable(reference_column);
 					}
 				}
 			}
@@ -320,7 +310,7 @@ void MysqlGenerator::generate_select_all_statement_function_member_variable(Gene
 	FunctionDefinition select_all_statement;
 	select_all_statement.generator = "MySQL";
 	select_all_statement.identifier = "MySQLSelectBy" + mv.identifier;
-	select_all_statement.return_type.identifier() = "std::vector<" + s.getIdentifier() + "Schema*>";
+	select_all_statement.return_type.setIdentifier("std::vector<" + s.getIdentifier() + "Schema*>");
 	select_all_statement.static_function = true;
 	select_all_statement.parameters.push_back(std::make_pair(mysql_session, "session"));
 	select_all_statement.parameters.push_back(std::make_pair(gen->convert_to_local_type(ps, mv.type), mv.identifier));
@@ -334,7 +324,7 @@ void MysqlGenerator::generate_select_all_statement_function_member_variable(Gene
 		structFile << "\t\tmysqlx::Table table = db.getTable(\"" << escape_identifier(s.getIdentifier()) << "\");\n";
 		structFile << "\t\tmysqlx::RowResult result = table.select(\"*\")\n";
 		structFile << "\t\t\t.where(\"" << escape_identifier(mv.identifier) << " = :param\")\n";\
-		if(ps->tokenIsEnum(mv.type.identifier())){
+		if(mv.type.is_enum(ps)){
 			structFile << "\t\t\t.bind(\"param\", "+mv.type.identifier()+"SchemaToString(" << mv.identifier << "))\n";
 		}else{
 			structFile << "\t\t\t.bind(\"param\", " << mv.identifier << ")\n";
@@ -419,7 +409,7 @@ void MysqlGenerator::generate_insert_statements_function_struct(Generator *gen,
 	FunctionDefinition insert_statement;
 	insert_statement.generator = "MySQL";
 	insert_statement.identifier = "MySQLInsert";
-	insert_statement.return_type.identifier() = "bool";
+	insert_statement.return_type.setIdentifier("bool");
 	insert_statement.static_function = true;
 	insert_statement.parameters.push_back(std::make_pair(mysql_session, "session"));
 	
@@ -542,7 +532,7 @@ void MysqlGenerator::generate_insert_statements_function_struct(Generator *gen,
 	FunctionDefinition insert_statement_no_args;
 	insert_statement_no_args.generator = "MySQL";
 	insert_statement_no_args.identifier = "MySQLInsert";
-	insert_statement_no_args.return_type.identifier() = "bool";
+	insert_statement_no_args.return_type.setIdentifier("bool");
 	insert_statement_no_args.static_function = false;
 	insert_statement_no_args.generate_function = [this](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
 	{
@@ -626,7 +616,7 @@ void MysqlGenerator::generate_update_all_statement_function_struct(Generator *ge
 	FunctionDefinition update_all_statement;
 	update_all_statement.generator = "MySQL";
 	update_all_statement.identifier = "MySQLUpdate" + s.getIdentifier();
-	update_all_statement.return_type.identifier() = "bool";
+	update_all_statement.return_type.setIdentifier("bool");
 	update_all_statement.static_function = true;
 	update_all_statement.parameters.push_back(std::make_pair(mysql_session, "session"));
 	
@@ -758,7 +748,7 @@ void MysqlGenerator::generate_update_statements_function_struct(Generator *gen,
 	FunctionDefinition update_statement;
 	update_statement.generator = "MySQL";
 	update_statement.identifier = "MySQLUpdate";
-	update_statement.return_type.identifier() = "bool";
+	update_statement.return_type.setIdentifier("bool");
 	update_statement.static_function = true;
 	update_statement.parameters.push_back(std::make_pair(mysql_session, "session"));
 	
@@ -880,7 +870,7 @@ void MysqlGenerator::generate_update_statements_function_struct(Generator *gen,
 	FunctionDefinition update_statement_no_args;
 	update_statement_no_args.generator = "MySQL";
 	update_statement_no_args.identifier = "MySQLUpdate";
-	update_statement_no_args.return_type.identifier() = "bool";
+	update_statement_no_args.return_type.setIdentifier("bool");
 	update_statement_no_args.static_function = false;
 	update_statement_no_args.generate_function = [this](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
 	{
@@ -963,7 +953,7 @@ void MysqlGenerator::generate_delete_statement_function_struct(Generator *gen, P
 	FunctionDefinition delete_statement;
 	delete_statement.generator = "MySQL";
 	delete_statement.identifier = "MySQLDelete";
-	delete_statement.return_type.identifier() = "bool";
+	delete_statement.return_type.setIdentifier("bool");
 	delete_statement.static_function = true;
 	delete_statement.parameters.push_back(std::make_pair(mysql_session, "session"));
 	
@@ -1035,7 +1025,7 @@ void MysqlGenerator::generate_delete_statement_function_struct(Generator *gen, P
 	FunctionDefinition delete_statement_no_args;
 	delete_statement_no_args.generator = "MySQL";
 	delete_statement_no_args.identifier = "MySQLDelete";
-	delete_statement_no_args.return_type.identifier() = "bool";
+	delete_statement_no_args.return_type.setIdentifier("bool");
 	delete_statement_no_args.static_function = false;
 	delete_statement_no_args.generate_function = [this](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
 	{
@@ -1088,37 +1078,27 @@ void MysqlGenerator::generate_delete_statement_function_struct(Generator *gen, P
 }
 
 // file generation functions
-bool MysqlGenerator::generate_create_table_file(ProgramStructure *ps, StructDefinition &s, std::string out_path)
+bool MysqlGenerator::generate_create_table_file(ProgramStructure *ps, StructDefinition &s, std::string out_path, OutputSink &sink)
 {
-	std::ofstream structFile(out_path + "/" + s.getIdentifier() + "_create_table.sql");
-	if (!structFile.is_open())
-	{
-		std::cout << "Failed to open file: " << out_path + "/" + s.getIdentifier() + "_create_table.sql" << std::endl;
-		return false;
-	}
+	GeneratedFile structFile(sink, out_path + "/" + s.getIdentifier() + "_create_table.sql");
 	structFile << generate_create_table_statement_string_struct(ps, s) << std::endl;
 	structFile.close();
 	return true;
 }
 
-bool MysqlGenerator::generate_select_all_files(ProgramStructure *ps, StructDefinition &s, std::string out_path)
+bool MysqlGenerator::generate_select_all_files(ProgramStructure *ps, StructDefinition &s, std::string out_path, OutputSink &sink)
 {
 	std::vector<std::string> sqls = generate_select_all_statements_string_struct(s);
 	for (int i = 0; i < sqls.size(); i++)
 	{
-		std::ofstream structFile(out_path + "/" + s.getIdentifier() + "_select_by_" + s.getMemberVariables()[i].second.identifier + ".sql");
-		if (!structFile.is_open())
-		{
-			std::cout << "Failed to open file: " << out_path + "/" + s.getIdentifier() + "_select_by_" + s.getMemberVariables()[i].second.identifier + ".sql" << std::endl;
-			return false;
-		}
+		GeneratedFile structFile(sink, out_path + "/" + s.getIdentifier() + "_select_by_" + s.getMemberVariables()[i].second.identifier + ".sql");
 		structFile << sqls[i] << std::endl;
 		structFile.close();
 	}
 	return true;
 }
 
-bool MysqlGenerator::generate_select_files(ProgramStructure *ps, StructDefinition &s, std::string out_path)
+bool MysqlGenerator::generate_select_files(ProgramStructure *ps, StructDefinition &s, std::string out_path, OutputSink &sink)
 {
 	std::vector<std::vector<int>> combinations = comb(s.getMemberVariables().size());
 	for (int i = 0; i < s.getMemberVariables().size(); i++)
@@ -1136,12 +1116,7 @@ bool MysqlGenerator::generate_select_files(ProgramStructure *ps, StructDefinitio
 				filename += "_" + s.getMemberVariables()[combinations[j][k]].second.identifier;
 			}
 			filename += ".sql";
-			std::ofstream structFile(filename);
-			if (!structFile.is_open())
-			{
-				std::cout << "Failed to open file: " << filename << std::endl;
-				return false;
-			}
+			GeneratedFile structFile(sink, filename);
 			structFile << sql << std::endl;
 			structFile.close();
 		}
@@ -1149,7 +1124,7 @@ bool MysqlGenerator::generate_select_files(ProgramStructure *ps, StructDefinitio
 	return true;
 }
 
-bool MysqlGenerator::generate_struct_files(ProgramStructure *ps, StructDefinition &s, std::string out_path)
+bool MysqlGenerator::generate_struct_files(ProgramStructure *ps, StructDefinition &s, std::string out_path, OutputSink &sink)
 {
 
 	if(s.whitelist()||s.blacklist()){
@@ -1158,26 +1133,21 @@ bool MysqlGenerator::generate_struct_files(ProgramStructure *ps, StructDefinitio
 		}
 	}
 
-	if (!std::filesystem::exists(out_path))
-	{
-		std::filesystem::create_directories(out_path);
-	}
-
-	if (!generate_create_table_file(ps, s, out_path))
+	if (!generate_create_table_file(ps, s, out_path, sink))
 	{
 		return false;
 	}
 
 
 	if(gen_select_all_files){
-		if (!generate_select_all_files(ps, s, out_path))
+		if (!generate_select_all_files(ps, s, out_path, sink))
 		{
 			return false;
 		}
 	}
 
 	if(gen_select_files){
-		if (!generate_select_files(ps, s, out_path))
+		if (!generate_select_files(ps, s, out_path, sink))
 		{
 			return false;
 		}
@@ -1363,13 +1333,13 @@ std::string MysqlGenerator::convert_to_local_type(ProgramStructure *ps, TypeDefi
 	}
 
 	// if the type is a enum, return VARCHAR
-	if (ps->tokenIsEnum(type.identifier()))
+	if (type.is_enum(ps))
 	{
 		return "VARCHAR(50)";
 	}
 
 	// if the type is a struct, return JSON
-	if (ps->tokenIsStruct(type.identifier()))
+	if (type.is_struct(ps))
 	{
 		return "JSON";
 	}
@@ -1446,7 +1416,7 @@ bool MysqlGenerator::add_generator_specific_content_to_struct(Generator *gen, Pr
 		FunctionDefinition setSession;
 		setSession.generator = name;
 		setSession.identifier = "setSession";
-		setSession.return_type.identifier() = "void";
+		setSession.return_type.setIdentifier("void");
 		setSession.static_function = true;
 		setSession.parameters.push_back(std::make_pair(TypeDefinition("mysqlx::Session*"), "newSession"));
 		setSession.generate_function = [this](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
@@ -1470,7 +1440,7 @@ bool MysqlGenerator::add_generator_specific_content_to_struct(Generator *gen, Pr
 		getMySQLCreateTableStatement.generator = name;
 		getMySQLCreateTableStatement.identifier = "getMySQLCreateTableStatement";
 		getMySQLCreateTableStatement.static_function = true;
-		getMySQLCreateTableStatement.return_type.identifier() = STRING;
+		getMySQLCreateTableStatement.return_type.setIdentifier(STRING);
 		getMySQLCreateTableStatement.generate_function = [this](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
 		{
 			structFile << "\treturn \"" << escape_string(generate_create_table_statement_string_struct(ps, s)) << "\";\n";
@@ -1482,7 +1452,7 @@ bool MysqlGenerator::add_generator_specific_content_to_struct(Generator *gen, Pr
 		createMySQLTable.generator = name;
 		createMySQLTable.identifier = "MySQLCreateTable";
 		createMySQLTable.static_function = true;
-		createMySQLTable.return_type.identifier() = BOOL;
+		createMySQLTable.return_type.setIdentifier(BOOL);
 		createMySQLTable.parameters.push_back(std::make_pair(mysql_session, "session"));
 		createMySQLTable.generate_function = [this](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
 		{
@@ -1502,7 +1472,7 @@ bool MysqlGenerator::add_generator_specific_content_to_struct(Generator *gen, Pr
 		registerUpdateListener.generator = name;
 		registerUpdateListener.identifier = "MySQLRegisterUpdateListener";
 		registerUpdateListener.static_function = true;
-		registerUpdateListener.return_type.identifier() = "bool";
+		registerUpdateListener.return_type.setIdentifier("bool");
 		registerUpdateListener.parameters.push_back(std::make_pair(mysql_session, "session"));
 		registerUpdateListener.generate_function = [this](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
 		{
@@ -1524,19 +1494,15 @@ bool MysqlGenerator::add_generator_specific_content_to_struct(Generator *gen, Pr
 	return true;
 }
 
-bool MysqlGenerator::generate_files(ProgramStructure ps, std::string out_path)
+bool MysqlGenerator::generate_files(ProgramStructure &ps, std::string out_path, OutputSink &sink)
 {
-	if (!std::filesystem::exists(out_path))
-	{
-		std::filesystem::create_directories(out_path);
-	}
-
 	// Add foreign key columns for array relationships before generating files
-	add_foreign_key_columns_for_arrays(&ps);
+	ModelOverlay overlay(ps);
+	add_foreign_key_columns_for_arrays(&ps, overlay);
 
-	for (auto &s : ps.getStructs())
+	for (size_t i = 0; i < overlay.size(); i++)
 	{
-		if (!generate_struct_files(&ps, s, out_path))
+		if (ps.rendersDefinition(overlay.get(i).getIdentifier()) && !generate_struct_files(&ps, overlay.get(i), out_path, sink))
 		{
 			return false;
 		}
@@ -91,11 +91,12 @@ std::string SqliteGenerator::generate_create_table_statement_string_struct(Progr
 }
 
 // Function to add foreign key columns for array relationships
-void SqliteGenerator::add_foreign_key_columns_for_arrays(ProgramStructure *ps)
+void SqliteGenerator::add_foreign_key_columns_for_arrays(ProgramStructure *ps, ModelOverlay &overlay)
 {
 	// Iterate through all structs
-	for (auto &parent_struct : ps->getStructs())
+	for (size_t i = 0; i < overlay.size(); i++)
 	{
+		StructDefinition &parent_struct = overlay.get(i);
 		// Look for array fields in this struct
 		for (auto & [generator, member_var] : parent_struct.getMemberVariables())
 		{
@@ -110,38 +111,27 @@ void SqliteGenerator::add_foreign_key_columns_for_arrays(ProgramStructure *ps)
 					// Find the target struct
 					std::string target_struct_name = element_type.identifier();
 					
-					// Find the target struct in the program structure
-					for (auto &target_struct : ps->getStructs())
+					// Find the target struct, the column goes into this generator's copy of it
+					StructDefinition *target = overlay.edit(target_struct_name);
+					if (target == nullptr)
 					{
-						if (target_struct.getIdentifier() == target_struct_name)
-						{
-							// Add foreign key column to the target struct
-							MemberVariableDefinition reference_column;
-							reference_column.identifier = parent_struct.getIdentifier() + "Id";
-							reference_column.type = TypeDefinition("int64");
-							reference_column.required = member_var.required; // If array is required, reference is NOT NULL
-							reference_column.reference.struct_name = parent_struct.getIdentifier();
-							reference_column.reference.variable_name = "id"; // Assuming parent has 'id' as primary key
-							reference_column.description = "Foreign key reference to " + parent_struct.getIdentifier() + " table";
-							
-							// Check if this foreign key column already exists
-							bool reference_exists = false;
-							for (auto &[generator,existing_var] : target_struct.getMemberVariables())
-							{
-								if (existing_var.identifier == reference_column.identifier)
-								{
-									reference_exists = true;
-									break;
-								}
-							}
-							
-							// Only add if it doesn't already exist
-							if (!reference_exists)
-							{
-								target_struct.add_member_variable(reference_column);
-							}
-							break;
-						}
+						continue;
+					}
+					StructDefinition &target_struct = *target;
+
+					// Add foreign key column to the target struct
+					MemberVariableDefinition reference_column;
+					reference_column.identifier = parent_struct.getIdentifier() + "Id";
+					reference_column.type = TypeDefinition("int64");
+					reference_column.required = member_var.required; // If array is required, reference is NOT NULL
+					reference_column.reference.struct_name = parent_struct.getIdentifier();
+					reference_column.reference.variable_name = "id"; // Assuming parent has 'id' as primary key
+					reference_column.description = "Foreign key reference to " + parent_struct.getIdentifier() + " table";
+					
+					// Only add if this foreign key column doesn't already exist
+					if (!target_struct.has_member_variable(reference_column.identifier))
+					{
+						target_struct.add_member_variable(reference_column);
 					}
 				}
 			}
@@ -387,7 +377,7 @@ void SqliteGenerator::generate_select_all_statement_function_member_variable(Gen
 	FunctionDefinition select_all_statement;
 	select_all_statement.generator = "SQLite";
 	select_all_statement.identifier = "SQLiteSelectBy" + mv.identifier;
-	select_all_statement.return_type.identifier() = "std::vector<" + s.getIdentifier() + "Schema*>";
+	select_all_statement.return_type.setIdentifier("std::vector<" + s.getIdentifier() + "Schema*>");
 	select_all_statement.static_function = true;
 	select_all_statement.parameters.push_back(std::make_pair(sqlite_db, "db"));
 	if(mv.required){
@@ -535,7 +525,7 @@ void SqliteGenerator::generate_insert_statements_function_struct(Generator *gen,
 	FunctionDefinition insert_statement;
 	insert_statement.generator = "SQLite";
 	insert_statement.identifier = "SQLiteInsert";
-	insert_statement.return_type.identifier() = BOOL;
+	insert_statement.return_type.setIdentifier(BOOL);
 	insert_statement.static_function = true;
 	insert_statement.parameters.push_back(std::make_pair(sqlite_db, "db"));
 	
@@ -621,7 +611,7 @@ void SqliteGenerator::generate_insert_statements_function_struct(Generator *gen,
 	FunctionDefinition insert_statement_no_args;
 	insert_statement_no_args.generator = "SQLite";
 	insert_statement_no_args.identifier = "SQLiteInsert";
-	insert_statement_no_args.return_type.identifier() = BOOL;
+	insert_statement_no_args.return_type.setIdentifier(BOOL);
 	insert_statement_no_args.static_function = false;
 	insert_statement_no_args.parameters.push_back(std::make_pair(TypeDefinition("sqlite3 *"), "db"));
 	insert_statement_no_args.generate_function = [this](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
@@ -669,7 +659,7 @@ void SqliteGenerator::generate_update_all_statement_function_struct(Generator *g
 	FunctionDefinition update_all_statement;
 	update_all_statement.generator = "SQLite";
 	update_all_statement.identifier = "SQLiteUpdate" + s.getIdentifier();
-	update_all_statement.return_type.identifier() = BOOL;
+	update_all_statement.return_type.setIdentifier(BOOL);
 	for (auto& [generator, mv] : s.getMemberVariables())
 	{
 		// Skip array fields - arrays are handled by foreign key relationships
@@ -721,7 +711,7 @@ void SqliteGenerator::generate_update_statements_function_struct(Generator *gen,
 	FunctionDefinition update_statement;
 	update_statement.generator = "SQLite";
 	update_statement.identifier = "SQLiteUpdate";
-	update_statement.return_type.identifier() = "bool";
+	update_statement.return_type.setIdentifier("bool");
 	update_statement.static_function = true;
 	update_statement.parameters.push_back(std::make_pair(sqlite_db, "db"));
 	
@@ -810,7 +800,7 @@ void SqliteGenerator::generate_update_statements_function_struct(Generator *gen,
 	FunctionDefinition update_statement_no_args;
 	update_statement_no_args.generator = "SQLite";
 	update_statement_no_args.identifier = "SQLiteUpdate";
-	update_statement_no_args.return_type.identifier() = "bool";
+	update_statement_no_args.return_type.setIdentifier("bool");
 	update_statement_no_args.static_function = false;
 	update_statement_no_args.generate_function = [this](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
 	{
@@ -861,7 +851,7 @@ void SqliteGenerator::generate_delete_statement_function_struct(Generator *gen,
 	FunctionDefinition delete_statement;
 	delete_statement.generator = "SQLite";
 	delete_statement.identifier = "SQLiteDelete";
-	delete_statement.return_type.identifier() = "bool";
+	delete_statement.return_type.setIdentifier("bool");
 	delete_statement.static_function = true;
 	delete_statement.parameters.push_back(std::make_pair(sqlite_db, "db"));
 	
@@ -927,7 +917,7 @@ void SqliteGenerator::generate_delete_statement_function_struct(Generator *gen,
 	FunctionDefinition delete_statement_no_args;
 	delete_statement_no_args.generator = "SQLite";
 	delete_statement_no_args.identifier = "SQLiteDelete";
-	delete_statement_no_args.return_type.identifier() = "bool";
+	delete_statement_no_args.return_type.setIdentifier("bool");
 	delete_statement_no_args.static_function = false;
 	delete_statement_no_args.parameters.push_back(std::make_pair(sqlite_db, "db"));
 	delete_statement_no_args.generate_function = [this](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
@@ -966,37 +956,27 @@ void SqliteGenerator::generate_delete_statement_function_struct(Generator *gen,
 }
 
 // file generation functions
-bool SqliteGenerator::generate_create_table_file(ProgramStructure *ps, StructDefinition &s, std::string out_path)
+bool SqliteGenerator::generate_create_table_file(ProgramStructure *ps, StructDefinition &s, std::string out_path, OutputSink &sink)
 {
-	std::ofstream structFile(out_path + "/" + s.getIdentifier() + "_create_table.sql");
-	if (!structFile.is_open())
-	{
-		std::cout << "Failed to open file: " << out_path + "/" + s.getIdentifier() + "_create_table.sql" << std::endl;
-		return false;
-	}
+	GeneratedFile structFile(sink, out_path + "/" + s.getIdentifier() + "_create_table.sql");
 	structFile << generate_create_table_statement_string_struct(ps, s) << std::endl;
 	structFile.close();
 	return true;
 }
 
-bool SqliteGenerator::generate_select_all_files(ProgramStructure *ps, StructDefinition &s, std::string out_path)
+bool SqliteGenerator::generate_select_all_files(ProgramStructure *ps, StructDefinition &s, std::string out_path, OutputSink &sink)
 {
 	std::vector<std::string> sqls = genrate_select_all_statements_string_struct(s);
 	for (int i = 0; i < sqls.size(); i++)
 	{
-		std::ofstream structFile(out_path + "/" + s.getIdentifier() + "_select_all_" + s.getMemberVariables()[i].second.identifier + ".sql");
-		if (!structFile.is_open())
-		{
-			std::cout << "Failed to open file: " << out_path + "/" + s.getIdentifier() + "_select_all_" + s.getMemberVariables()[i].second.identifier + ".sql" << std::endl;
-			return false;
-		}
+		GeneratedFile structFile(sink, out_path + "/" + s.getIdentifier() + "_select_all_" + s.getMemberVariables()[i].second.identifier + ".sql");
 		structFile << sqls[i] << std::endl;
 		structFile.close();
 	}
 	return true;
 }
 
-bool SqliteGenerator::generate_select_files(ProgramStructure *ps, StructDefinition &s, std::string out_path)
+bool SqliteGenerator::generate_select_files(ProgramStructure *ps, StructDefinition &s, std::string out_path, OutputSink &sink)
 {
 	std::vector<std::vector<int>> combinations = comb(s.getMemberVariables().size());
 	for (int i = 0; i < s.getMemberVariables().size(); i++)
@@ -1007,30 +987,18 @@ bool SqliteGenerator::generate_select_files(ProgramStructure *ps, StructDefiniti
 		}
 		for (int j = 0; j < combinations.size(); j++)
 		{
-			std::ofstream structFile(out_path + "/" + s.getIdentifier() + "_select_" + s.getMemberVariables()[i].second.identifier + "_by_");
+			// the name has to be complete before the file is written
+			std::string filename = out_path + "/" + s.getIdentifier() + "_select_" + s.getMemberVariables()[i].second.identifier + "_by_";
 			for (int k = 0; k < combinations[j].size(); k++)
 			{
-				structFile << s.getMemberVariables()[combinations[j][k]].second.identifier;
+				filename += s.getMemberVariables()[combinations[j][k]].second.identifier;
 				if (k < combinations[j].size() - 1)
 				{
-					structFile << "_";
+					filename += "_";
 				}
 			}
-			structFile << ".sql";
-			if (!structFile.is_open())
-			{
-				std::cout << "Failed to open file: " << out_path + "/" + s.getIdentifier() + "_select_" + s.getMemberVariables()[i].second.identifier + "_by_";
-				for (int k = 0; k < combinations[j].size(); k++)
-				{
-					structFile << s.getMemberVariables()[combinations[j][k]].second.identifier;
-					if (k < combinations[j].size() - 1)
-					{
-						structFile << "_";
-					}
-				}
-				structFile << ".sql" << std::endl;
-				return false;
-			}
+			filename += ".sql";
+			GeneratedFile structFile(sink, filename);
 			structFile << generate_select_by_member_variable_statement_string(s, s.getMemberVariables()[i].second, combinations[j]) << std::endl;
 			structFile.close();
 		}
@@ -1038,14 +1006,9 @@ bool SqliteGenerator::generate_select_files(ProgramStructure *ps, StructDefiniti
 	return true;
 }
 
-bool SqliteGenerator::generate_struct_files(ProgramStructure *ps, StructDefinition &s, std::string out_path)
+bool SqliteGenerator::generate_struct_files(ProgramStructure *ps, StructDefinition &s, std::string out_path, OutputSink &sink)
 {
-	if (!std::filesystem::exists(out_path))
-	{
-		std::filesystem::create_directories(out_path);
-	}
-
-	if (!generate_create_table_file(ps, s, out_path))
+	if (!generate_create_table_file(ps, s, out_path, sink))
 	{
 		std::cout << "Failed to generate create table file for struct: " << s.getIdentifier() << std::endl;
 		return false;
@@ -1185,7 +1148,7 @@ bool SqliteGenerator::add_generator_specific_content_to_struct(Generator *gen, P
 		getCreateTableStatement.generator = name;
 		getCreateTableStatement.identifier = "getSQLiteCreateTableStatement";
 		getCreateTableStatement.static_function = true;
-		getCreateTableStatement.return_type.identifier() = STRING;
+		getCreateTableStatement.return_type.setIdentifier(STRING);
 		getCreateTableStatement.generate_function = [this](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
 		{
 			structFile << "\treturn \"" << escape_string(generate_create_table_statement_string_struct(ps, s)) << "\";\n";
@@ -1197,7 +1160,7 @@ bool SqliteGenerator::add_generator_specific_content_to_struct(Generator *gen, P
 		createTable.generator = name;
 		createTable.identifier = "SQLiteCreateTable";
 		createTable.static_function = true;
-		createTable.return_type.identifier() = BOOL;
+		createTable.return_type.setIdentifier(BOOL);
 		createTable.parameters.push_back(std::make_pair(TypeDefinition("sqlite3 *"), "db"));
 		createTable.static_function = true;
 		createTable.generate_function = [this](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
@@ -1219,7 +1182,7 @@ bool SqliteGenerator::add_generator_specific_content_to_struct(Generator *gen, P
 		registerUpdateListener.generator = name;
 		registerUpdateListener.identifier = "SQLiteRegisterUpdateListener";
 		registerUpdateListener.static_function = true;
-		registerUpdateListener.return_type.identifier() = "bool";
+		registerUpdateListener.return_type.setIdentifier("bool");
 		registerUpdateListener.parameters.push_back(std::make_pair(TypeDefinition("sqlite3 *"), "db"));
 		registerUpdateListener.generate_function = [this](Generator *gen, ProgramStructure *ps, StructDefinition &s, FunctionDefinition &fd, std::ostream &structFile)
 		{
@@ -1241,22 +1204,17 @@ bool SqliteGenerator::add_generator_specific_content_to_struct(Generator *gen, P
 	return true;
 }
 
-#include <inja/inja.hpp>
-#include <EmbeddedResources/EmbeddedResourcesEmbeddedVFS.hpp>
+#include <CompiledTemplate.hpp>
 
-bool SqliteGenerator::generate_files(ProgramStructure ps, std::string out_path)
+bool SqliteGenerator::generate_files(ProgramStructure &ps, std::string out_path, OutputSink &sink)
 {
-	if (!std::filesystem::exists(out_path))
-	{
-		std::filesystem::create_directories(out_path);
-	}
-
 	// Add foreign key columns for array relationships before generating files
-	add_foreign_key_columns_for_arrays(&ps);
+	ModelOverlay overlay(ps);
+	add_foreign_key_columns_for_arrays(&ps, overlay);
 
 	// for (auto &s : ps.getStructs())
 	// {
-	// 	if (!generate_struct_files(&ps, s, out_path))
+	// 	if (!generate_struct_files(&ps, s, out_path, sink))
 	// 	{
 	// 		std::cout << "Failed to generate sqlite file for struct: " << s.getIdentifier() << std::endl;
 	// 		return false;
@@ -1267,27 +1225,21 @@ bool SqliteGenerator::generate_files(ProgramStructure ps, std::string out_path)
 	//env.set_trim_blocks(true);
 	//env.set_lstrip_blocks(false);
 
-	std::map<std::string, std::string> struct_name_content_pairs;
-	// open file
-	std::vector<std::string> files = listEmbeddedResourcesEmbeddedFiles("/SQLite/struct/");
-	for (auto &file : files)
-	{
-		std::string content(reinterpret_cast<const char *>(loadEmbeddedResourcesEmbeddedFile(("/SQLite/struct/" + file).c_str()).data()), loadEmbeddedResourcesEmbeddedFile(("/SQLite/struct/" + file).c_str()).size());
-		std::string filename = std::filesystem::path(file).filename().string();
-		struct_name_content_pairs[filename] = content;
-	}
-
-	std::map<std::string, std::string> enum_name_content_pairs;
-	files = listEmbeddedResourcesEmbeddedFiles("/SQLite/enum/");
-	for (auto &file : files)
+	// every template and output path pattern is parsed once per run
+	std::vector<CompiledTemplate> struct_templates;
+	std::vector<CompiledTemplate> enum_templates;
+	if (!compileTemplates(env, "/SQLite/struct/", out_path, struct_templates) || !compileTemplates(env, "/SQLite/enum/", out_path, enum_templates))
 	{
-		std::string content(reinterpret_cast<const char *>(loadEmbeddedResourcesEmbeddedFile(("/SQLite/enum/" + file).c_str()).data()), loadEmbeddedResourcesEmbeddedFile(("/SQLite/enum/" + file).c_str()).size());
-		std::string filename = std::filesystem::path(file).filename().string();
-		enum_name_content_pairs[filename] = content;
+		return false;
 	}
 
-	for (auto &s : ps.getStructs())
+	for (size_t i = 0; i < overlay.size(); i++)
 	{
+		StructDefinition &s = overlay.get(i);
+		if (!ps.rendersDefinition(s.getIdentifier()))
+		{
+			continue;
+		}
 		inja::json data;
 		data["struct"] = s.getIdentifier();
 		data["fields"] = inja::json::array();
@@ -1358,17 +1310,7 @@ bool SqliteGenerator::generate_files(ProgramStructure ps, std::string out_path)
 
 		try
 		{
-			for (auto &file : struct_name_content_pairs)
-			{
-				std::ofstream of(env.render(out_path + "/" + file.first, data));
-				if (!of.is_open())
-				{
-					std::cout << "Failed to open file: " << env.render(out_path + "/" + file.first, data);
-				}
-				of << env.render(file.second, data);
-				of.close();
-				std::cout << "Generated file: " << env.render(out_path + "/" + file.first, data) << std::endl;
-			}
+			renderTemplates(env, struct_templates, data, sink);
 		}
 		catch (const std::exception &e)
 		{
@@ -1379,6 +1321,10 @@ bool SqliteGenerator::generate_files(ProgramStructure ps, std::string out_path)
 
 	for (auto &e : ps.getEnums())
 	{
+		if (!ps.rendersDefinition(e.identifier))
+		{
+			continue;
+		}
 		inja::json data;
 		data["enum"] = e.identifier;
 
@@ -1393,17 +1339,7 @@ bool SqliteGenerator::generate_files(ProgramStructure ps, std::string out_path)
 
 		try
 		{
-			for (auto &file : enum_name_content_pairs)
-			{
-				std::ofstream of(env.render(out_path + "/" + file.first, data));
-				if (!of.is_open())
-				{
-					std::cout << "Failed to open file: " << env.render(out_path + "/" + file.first, data);
-				}
-				of << env.render(file.second, data);
-				of.close();
-				std::cout << "Generated file: " << env.render(out_path + "/" + file.first, data) << std::endl;
-			}
+			renderTemplates(env, enum_templates, data, sink);
 		}
 		catch (const std::exception &ex)
 		{
@@ -0,0 +1,41 @@
+#include <CompiledTemplate.hpp>
+#include <GeneratedFile.hpp>
+#include <TemplateCache.hpp>
+#include <filesystem>
+#include <iostream>
+#include <map>
+
+bool compileTemplates(inja::Environment &env, const std::string &directory, const std::string &out_path, std::vector<CompiledTemplate> &templates)
+{
+	TemplateCache &cache = TemplateCache::instance();
+	std::map<std::string, std::string_view> sources;
+	for (auto &file : cache.list(directory))
+	{
+		sources[std::filesystem::path(file).filename().string()] = cache.load(directory + file);
+	}
+
+	templates.clear();
+	for (auto &[name, source] : sources)
+	{
+		try
+		{
+			templates.push_back({name, env.parse(out_path + "/" + name), env.parse(source)});
+		}
+		catch (const std::exception &e)
+		{
+			std::cout << "Error parsing template " << directory << name << ": " << e.what() << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+void renderTemplates(inja::Environment &env, const std::vector<CompiledTemplate> &templates, const inja::json &data, OutputSink &sink)
+{
+	for (auto &t : templates)
+	{
+		GeneratedFile file(sink, env.render(t.path, data));
+		env.render_to(file, t.content, data);
+		file.close();
+	}
+}
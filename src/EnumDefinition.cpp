@@ -5,7 +5,7 @@ void EnumDefinition::add_value(std::string identifier, int value)
 	values.insert(std::make_pair(identifier, value));
 }
 
-void EnumDefinition::update(EnumDefinition def)
+void EnumDefinition::update(const EnumDefinition &def)
 {
 	// Merge
 	if (identifier!=def.identifier){
@@ -0,0 +1,31 @@
+#include <FileTable.hpp>
+
+FileTable::FileTable()
+{
+	lookup.emplace(paths.emplace_back(), 0);
+}
+
+FileTable &FileTable::instance()
+{
+	static FileTable table;
+	return table;
+}
+
+FileId FileTable::intern(std::string_view path)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = lookup.find(path);
+	if (it != lookup.end())
+	{
+		return it->second;
+	}
+	FileId id = (FileId)paths.size();
+	lookup.emplace(paths.emplace_back(path), id);
+	return id;
+}
+
+const std::string &FileTable::path(FileId id)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return id < paths.size() ? paths[id] : paths[0];
+}
@@ -0,0 +1,684 @@
+#include <LanguageServer.hpp>
+#include <ProgramStructure.hpp>
+#include <BaseTypes.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using json = nlohmann::json;
+
+// JSON-RPC error codes
+static const int parse_error = -32700;
+static const int invalid_request = -32600;
+static const int method_not_found = -32601;
+static const int invalid_params = -32602;
+
+// bodies above this are treated as a broken header rather than allocated
+static const size_t max_content_length = 64 * 1024 * 1024;
+
+// completion item kinds from the protocol
+static const int kind_keyword = 14;
+static const int kind_struct = 22;
+static const int kind_enum = 13;
+
+static const char *const keywords[] = {
+	"struct", "enum", "include", "declare", "config",
+	"required", "optional", "unique", "primary_key", "auto_increment", "reference",
+	"description", "min_items", "max_items", "gens_enabled", "gens_disabled"};
+
+static const char *const base_types[] = {INT8, INT16, INT32, INT64, UINT8, UINT16, UINT32, UINT64, FLOAT, DOUBLE, BOOL, STRING, CHAR, ARRAY};
+
+static bool is_identifier_char(char c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// object[key] if it is a string, false if it is missing or of another type
+static bool get_string(const json &object, const char *key, std::string &value)
+{
+	if (!object.is_object() || !object.contains(key) || !object[key].is_string())
+	{
+		return false;
+	}
+	value = object[key].get<std::string>();
+	return true;
+}
+
+// the path of params.textDocument.uri
+static bool get_document_path(const json &params, std::string &path)
+{
+	std::string uri;
+	if (!params.is_object() || !params.contains("textDocument") || !get_string(params["textDocument"], "uri", uri))
+	{
+		return false;
+	}
+	path = LanguageServer::uriToPath(uri);
+	return true;
+}
+
+static int hex_value(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+static bool is_schema_file(const std::filesystem::path &path)
+{
+	return path.extension() == ".schema" || path.extension() == ".schemaLang";
+}
+
+// whether collectWorkspaceFiles would list path, it must be a schema file
+// below root and not inside a hidden directory
+static bool is_workspace_file(const std::string &root, const std::string &path)
+{
+	if (root.empty() || !is_schema_file(path))
+	{
+		return false;
+	}
+	std::filesystem::path relative = std::filesystem::path(path).lexically_relative(root);
+	if (relative.empty())
+	{
+		return false;
+	}
+	for (const auto &part : relative)
+	{
+		if (part.string().rfind(".", 0) == 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+LanguageServer::LanguageServer()
+{
+	// memory only, the editor session is the only user of these parses
+	parse_cache = std::make_shared<ParseCache>("", ProgramStructure::parserVersion());
+	parse_cache->setKeepInMemory(true);
+	sources = std::make_shared<std::unordered_map<std::string, std::string>>();
+}
+
+std::string LanguageServer::uriToPath(const std::string &uri)
+{
+	std::string encoded = uri.rfind("file://", 0) == 0 ? uri.substr(7) : uri;
+	std::string path;
+	for (size_t i = 0; i < encoded.size(); i++)
+	{
+		if (encoded[i] == '%' && i + 2 < encoded.size() && hex_value(encoded[i + 1]) >= 0 && hex_value(encoded[i + 2]) >= 0)
+		{
+			path += (char)(hex_value(encoded[i + 1]) * 16 + hex_value(encoded[i + 2]));
+			i += 2;
+		}
+		else
+		{
+			path += encoded[i];
+		}
+	}
+	// file:///C:/dir on Windows
+	if (path.size() > 2 && path[0] == '/' && path[2] == ':')
+	{
+		path.erase(0, 1);
+	}
+	return std::filesystem::path(path).lexically_normal().string();
+}
+
+std::string LanguageServer::pathToUri(const std::string &path)
+{
+	std::string normal = std::filesystem::path(path).lexically_normal().generic_string();
+	std::string uri = normal.empty() || normal[0] != '/' ? "file:///" : "file://";
+	static const char hex[] = "0123456789ABCDEF";
+	for (unsigned char c : normal)
+	{
+		if (is_identifier_char(c) || c == '/' || c == '-' || c == '.' || c == '~' || c == ':')
+		{
+			uri += c;
+		}
+		else
+		{
+			uri += '%';
+			uri += hex[c >> 4];
+			uri += hex[c & 15];
+		}
+	}
+	return uri;
+}
+
+bool LanguageServer::readMessage(std::istream &in, json &message)
+{
+	size_t content_length = 0;
+	std::string header;
+	while (std::getline(in, header))
+	{
+		if (!header.empty() && header.back() == '\r')
+		{
+			header.pop_back();
+		}
+		if (header.empty())
+		{
+			break;
+		}
+		if (header.rfind("Content-Length:", 0) == 0)
+		{
+			// a malformed length stays 0, the stream can not be framed after it
+			size_t pos = header.find_first_not_of(' ', 15);
+			content_length = 0;
+			for (; pos < header.size() && header[pos] >= '0' && header[pos] <= '9' && content_length < max_content_length; pos++)
+			{
+				content_length = content_length * 10 + (header[pos] - '0');
+			}
+			if (pos != header.size() || content_length > max_content_length)
+			{
+				content_length = 0;
+			}
+		}
+	}
+	if (!in || content_length == 0)
+	{
+		return false;
+	}
+	std::string body(content_length, '\0');
+	if (!in.read(&body[0], content_length))
+	{
+		return false;
+	}
+	// a body that is not JSON is left discarded for run() to answer
+	message = json::parse(body, nullptr, false);
+	return true;
+}
+
+void LanguageServer::send(const json &message)
+{
+	std::string body = message.dump();
+	*out << "Content-Length: " << body.size() << "\r\n\r\n"
+		 << body;
+	out->flush();
+}
+
+void LanguageServer::respond(const json &id, const json &result)
+{
+	send({{"jsonrpc", "2.0"}, {"id", id}, {"result", result}});
+}
+
+void LanguageServer::respondError(const json &id, int code, const std::string &message)
+{
+	send({{"jsonrpc", "2.0"}, {"id", id}, {"error", {{"code", code}, {"message", message}}}});
+}
+
+void LanguageServer::collectWorkspaceFiles()
+{
+	workspace_files.clear();
+	std::error_code ec;
+	if (root.empty() || !std::filesystem::is_directory(root, ec))
+	{
+		return;
+	}
+	auto it = std::filesystem::recursive_directory_iterator(root, std::filesystem::directory_options::skip_permission_denied, ec);
+	for (; !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+	{
+		// skips .git, the parse cache and other tool directories
+		if (it->is_directory() && it->path().filename().string().rfind(".", 0) == 0)
+		{
+			it.disable_recursion_pending();
+			continue;
+		}
+		if (it->is_regular_file() && is_schema_file(it->path()))
+		{
+			workspace_files.push_back(it->path().lexically_normal().string());
+		}
+	}
+	std::sort(workspace_files.begin(), workspace_files.end());
+	for (const auto &path : workspace_files)
+	{
+		reloadFile(path);
+	}
+}
+
+bool LanguageServer::readText(const std::string &path, std::string &text)
+{
+	auto it = sources->find(path);
+	if (it != sources->end())
+	{
+		text = it->second;
+		return true;
+	}
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+	text = buffer.str();
+	return true;
+}
+
+void LanguageServer::reloadFile(const std::string &path)
+{
+	// the editor's buffer wins over the file on disk
+	if (open_documents.count(path) != 0)
+	{
+		return;
+	}
+	sources->erase(path);
+	std::string text;
+	if (!readText(path, text))
+	{
+		index.erase(path);
+		return;
+	}
+	(*sources)[path] = std::move(text);
+	indexFile(path);
+}
+
+void LanguageServer::registerWatcher()
+{
+	if (!can_register_watcher)
+	{
+		return;
+	}
+	json watchers = json::array({{{"globPattern", "**/*.schema"}}, {{"globPattern", "**/*.schemaLang"}}});
+	json registration = {{"id", "schema-files"}, {"method", "workspace/didChangeWatchedFiles"}, {"registerOptions", {{"watchers", watchers}}}};
+	send({{"jsonrpc", "2.0"}, {"id", "register-schema-files"}, {"method", "client/registerCapability"}, {"params", {{"registrations", {registration}}}}});
+}
+
+// applies workspace/didChangeWatchedFiles, the only time files on disk are reread
+void LanguageServer::filesChanged(const json &changes)
+{
+	// file change types from the protocol
+	static const int deleted = 3;
+	for (const auto &change : changes)
+	{
+		std::string uri;
+		if (!get_string(change, "uri", uri) || !change.contains("type") || !change["type"].is_number_integer())
+		{
+			continue;
+		}
+		std::string path = uriToPath(uri);
+		if (!is_workspace_file(root, path))
+		{
+			continue;
+		}
+		auto it = std::lower_bound(workspace_files.begin(), workspace_files.end(), path);
+		bool listed = it != workspace_files.end() && *it == path;
+		if (change["type"].get<int>() == deleted)
+		{
+			if (listed)
+			{
+				workspace_files.erase(it);
+			}
+			if (open_documents.count(path) == 0)
+			{
+				sources->erase(path);
+				index.erase(path);
+			}
+			continue;
+		}
+		if (!listed)
+		{
+			workspace_files.insert(it, path);
+		}
+		reloadFile(path);
+	}
+}
+
+// records where the structs and enums of a file are defined
+void LanguageServer::indexFile(const std::string &path)
+{
+	std::string text;
+	if (!readText(path, text))
+	{
+		index.erase(path);
+		return;
+	}
+	uint64_t hash = ParseCache::hash(text);
+	auto it = index.find(path);
+	if (it != index.end() && it->second.hash == hash)
+	{
+		return;
+	}
+
+	ProgramStructure lexer;
+	std::string ignored;
+	lexer.diagnostics = &ignored;
+	std::vector<Token> tokens = lexer.tokenizeWithPosition(text, path);
+	IndexedFile &file = index[path];
+	file.hash = hash;
+	file.definitions.clear();
+	for (size_t t = 0; t + 1 < tokens.size(); t++)
+	{
+		if ((tokens[t] != "struct" && tokens[t] != "enum") || (t > 0 && tokens[t - 1] == "declare"))
+		{
+			continue;
+		}
+		// token positions point just past the token
+		const Token &name = tokens[t + 1];
+		Definition definition;
+		definition.name = name.str();
+		definition.line = name.position.line - 1;
+		definition.length = (int)name.value.size();
+		definition.character = std::max(0, name.position.column - 1 - definition.length);
+		file.definitions.push_back(definition);
+	}
+}
+
+void LanguageServer::rebuild()
+{
+	// open documents first, so their errors are reported before the rest
+	std::vector<std::string> inputs;
+	for (const auto &[path, text] : open_documents)
+	{
+		inputs.push_back(path);
+	}
+	std::sort(inputs.begin(), inputs.end());
+	for (const auto &path : workspace_files)
+	{
+		if (open_documents.count(path) == 0)
+		{
+			inputs.push_back(path);
+		}
+	}
+
+	ProgramStructure ps;
+	std::string output;
+	ps.diagnostics = &output; // stdout carries the protocol
+	ps.parse_cache = parse_cache;
+	// every input comes from memory, only includes outside the workspace are read from disk
+	ps.unsaved_files = sources;
+	ps.readFiles(inputs);
+
+	std::map<std::string, json> diagnostics;
+	for (const auto &error : ps.reported_errors)
+	{
+		// an error that belongs to no file can only go to the client's log
+		if (error.position.file_id == 0)
+		{
+			send({{"jsonrpc", "2.0"}, {"method", "window/logMessage"}, {"params", {{"type", 1}, {"message", error.message}}}});
+			continue;
+		}
+		std::string path = std::filesystem::path(error.position.file_path()).lexically_normal().string();
+		int line = std::max(0, error.position.line - 1);
+		int end = std::max(0, error.position.column - 1);
+		int start = std::max(0, end - (int)error.length);
+		json range = {{"start", {{"line", line}, {"character", start}}}, {"end", {{"line", line}, {"character", end}}}};
+		diagnostics[path].push_back({{"range", range}, {"severity", 1}, {"source", "schemalang"}, {"message", error.message}});
+	}
+	for (const auto &path : files_with_diagnostics)
+	{
+		if (diagnostics.count(path) == 0)
+		{
+			diagnostics[path] = json::array();
+		}
+	}
+	files_with_diagnostics.clear();
+	for (auto &[path, list] : diagnostics)
+	{
+		if (!list.empty())
+		{
+			files_with_diagnostics.insert(path);
+		}
+		send({{"jsonrpc", "2.0"}, {"method", "textDocument/publishDiagnostics"}, {"params", {{"uri", pathToUri(path)}, {"diagnostics", list}}}});
+	}
+
+	struct_names.clear();
+	enum_names.clear();
+	for (auto &s : ps.getStructs())
+	{
+		struct_names.push_back(s.getIdentifier());
+	}
+	for (auto &e : ps.getEnums())
+	{
+		enum_names.push_back(e.identifier);
+	}
+}
+
+bool LanguageServer::definition(const json &params, json &result)
+{
+	result = nullptr;
+	std::string path;
+	if (!get_document_path(params, path) || !params.contains("position") || !params["position"].is_object())
+	{
+		return false;
+	}
+	const json &position = params["position"];
+	if (!position.contains("line") || !position["line"].is_number_unsigned() || !position.contains("character") || !position["character"].is_number_unsigned())
+	{
+		return false;
+	}
+	size_t line = position["line"].get<size_t>();
+	size_t character = position["character"].get<size_t>();
+
+	std::string text;
+	if (!readText(path, text))
+	{
+		return true;
+	}
+	size_t line_start = 0;
+	for (size_t i = 0; i < line && line_start != std::string::npos; i++)
+	{
+		line_start = text.find('\n', line_start);
+		line_start = line_start == std::string::npos ? line_start : line_start + 1;
+	}
+	if (line_start == std::string::npos)
+	{
+		return true;
+	}
+	size_t line_end = std::min(text.find('\n', line_start), text.size());
+	size_t begin = line_start + std::min(character, line_end - line_start);
+	size_t end = begin;
+	while (begin > line_start && is_identifier_char(text[begin - 1]))
+	{
+		begin--;
+	}
+	while (end < line_end && is_identifier_char(text[end]))
+	{
+		end++;
+	}
+	std::string word = text.substr(begin, end - begin);
+	if (word.empty())
+	{
+		return true;
+	}
+
+	for (const auto &[file_path, file] : index)
+	{
+		for (const auto &definition : file.definitions)
+		{
+			if (definition.name == word)
+			{
+				json range = {{"start", {{"line", definition.line}, {"character", definition.character}}},
+							  {"end", {{"line", definition.line}, {"character", definition.character + definition.length}}}};
+				result = {{"uri", pathToUri(file_path)}, {"range", range}};
+				return true;
+			}
+		}
+	}
+	return true;
+}
+
+json LanguageServer::completion()
+{
+	json items = json::array();
+	for (const char *keyword : keywords)
+	{
+		items.push_back({{"label", keyword}, {"kind", kind_keyword}});
+	}
+	for (const char *type : base_types)
+	{
+		items.push_back({{"label", type}, {"kind", kind_keyword}, {"detail", "base type"}});
+	}
+	for (const auto &name : struct_names)
+	{
+		items.push_back({{"label", name}, {"kind", kind_struct}, {"detail", "struct"}});
+	}
+	for (const auto &name : enum_names)
+	{
+		items.push_back({{"label", name}, {"kind", kind_enum}, {"detail", "enum"}});
+	}
+	return items;
+}
+
+int LanguageServer::run(std::istream &in, std::ostream &output)
+{
+	out = &output;
+	json message;
+	while (readMessage(in, message))
+	{
+		if (message.is_discarded())
+		{
+			respondError(nullptr, parse_error, "Message is not valid JSON");
+			continue;
+		}
+		bool is_request = message.is_object() && message.contains("id");
+		std::string method;
+		if (!get_string(message, "method", method))
+		{
+			// responses to server requests carry no method and need no answer
+			if (!message.is_object() || message.contains("method"))
+			{
+				respondError(is_request ? message["id"] : json(nullptr), invalid_request, "Message has no method");
+			}
+			continue;
+		}
+		json params = message.contains("params") && !message["params"].is_null() ? message["params"] : json::object();
+
+		// bad parameters fail the request but never the server, notifications
+		// with bad parameters are dropped since they can not be answered
+		try
+		{
+			if (!dispatch(method, params, is_request ? message["id"] : json(nullptr), is_request))
+			{
+				if (is_request)
+				{
+					respondError(message["id"], invalid_params, "Invalid parameters for " + method);
+				}
+			}
+		}
+		catch (const json::exception &e)
+		{
+			if (is_request)
+			{
+				respondError(message["id"], invalid_params, e.what());
+			}
+		}
+		if (method == "exit")
+		{
+			return shutdown_requested ? 0 : 1;
+		}
+	}
+	return 1;
+}
+
+bool LanguageServer::dispatch(const std::string &method, const json &params, const json &id, bool is_request)
+{
+	if (!params.is_object())
+	{
+		return false;
+	}
+	if (method == "initialize")
+	{
+		std::string uri;
+		if (get_string(params, "rootUri", uri))
+		{
+			root = uriToPath(uri);
+		}
+		else
+		{
+			get_string(params, "rootPath", root);
+		}
+		json::json_pointer watch_capability("/capabilities/workspace/didChangeWatchedFiles/dynamicRegistration");
+		can_register_watcher = params.contains(watch_capability) && params[watch_capability].is_boolean() && params[watch_capability].get<bool>();
+		collectWorkspaceFiles();
+		json capabilities = {
+			{"textDocumentSync", {{"openClose", true}, {"change", 1}}},
+			{"definitionProvider", true},
+			{"completionProvider", {{"triggerCharacters", {":", " "}}}}};
+		respond(id, {{"capabilities", capabilities}, {"serverInfo", {{"name", "SchemaLangTranspiler"}}}});
+	}
+	else if (method == "initialized")
+	{
+		registerWatcher();
+		rebuild();
+	}
+	else if (method == "textDocument/didOpen" || method == "textDocument/didChange")
+	{
+		std::string path;
+		std::string text;
+		if (!get_document_path(params, path))
+		{
+			return false;
+		}
+		if (method == "textDocument/didOpen")
+		{
+			if (!get_string(params["textDocument"], "text", text))
+			{
+				return false;
+			}
+		}
+		// full document sync, the last change holds the whole text
+		else if (!params.contains("contentChanges") || !params["contentChanges"].is_array() || params["contentChanges"].empty() || !get_string(params["contentChanges"].back(), "text", text))
+		{
+			return false;
+		}
+		open_documents[path] = text;
+		(*sources)[path] = std::move(text);
+		indexFile(path);
+		rebuild();
+	}
+	else if (method == "textDocument/didClose")
+	{
+		std::string path;
+		if (!get_document_path(params, path))
+		{
+			return false;
+		}
+		open_documents.erase(path);
+		if (std::binary_search(workspace_files.begin(), workspace_files.end(), path))
+		{
+			reloadFile(path);
+		}
+		else
+		{
+			sources->erase(path);
+			index.erase(path);
+		}
+		rebuild();
+	}
+	else if (method == "workspace/didChangeWatchedFiles")
+	{
+		if (!params.contains("changes") || !params["changes"].is_array())
+		{
+			return false;
+		}
+		filesChanged(params["changes"]);
+		rebuild();
+	}
+	else if (method == "textDocument/definition")
+	{
+		json result;
+		if (!definition(params, result))
+		{
+			return false;
+		}
+		respond(id, result);
+	}
+	else if (method == "textDocument/completion")
+	{
+		respond(id, completion());
+	}
+	else if (method == "shutdown")
+	{
+		shutdown_requested = true;
+		respond(id, nullptr);
+	}
+	else if (method != "exit" && is_request)
+	{
+		respondError(id, method_not_found, "Unsupported method " + method);
+	}
+	return true;
+}
@@ -0,0 +1,39 @@
+#include <ModelOverlay.hpp>
+#include <ProgramStructure.hpp>
+
+ModelOverlay::ModelOverlay(ProgramStructure &model) : model(&model), edited(model.structs.size())
+{
+}
+
+size_t ModelOverlay::size() const
+{
+	return edited.size();
+}
+
+StructDefinition &ModelOverlay::get(size_t index)
+{
+	if (edited[index])
+	{
+		return *edited[index];
+	}
+	return model->structs[index];
+}
+
+StructDefinition &ModelOverlay::edit(size_t index)
+{
+	if (!edited[index])
+	{
+		edited[index] = std::make_unique<StructDefinition>(model->structs[index]);
+	}
+	return *edited[index];
+}
+
+StructDefinition *ModelOverlay::edit(std::string_view identifier)
+{
+	auto it = model->struct_indices.find(identifier);
+	if (it == model->struct_indices.end())
+	{
+		return nullptr;
+	}
+	return &edit(it->second);
+}
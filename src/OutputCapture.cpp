@@ -0,0 +1,67 @@
+#include <OutputCapture.hpp>
+#include <iostream>
+#include <streambuf>
+
+namespace
+{
+	thread_local std::string *capture_target = nullptr;
+
+	// replaces the buffer of std::cout, forwards to the console unless the
+	// writing thread has an OutputCapture
+	class CaptureBuffer : public std::streambuf
+	{
+		std::streambuf *console;
+
+	public:
+		explicit CaptureBuffer(std::streambuf *console) : console(console) {}
+
+	protected:
+		int_type overflow(int_type c) override
+		{
+			if (traits_type::eq_int_type(c, traits_type::eof()))
+			{
+				return traits_type::not_eof(c);
+			}
+			if (capture_target != nullptr)
+			{
+				capture_target->push_back(traits_type::to_char_type(c));
+				return c;
+			}
+			return console->sputc(traits_type::to_char_type(c));
+		}
+
+		std::streamsize xsputn(const char *s, std::streamsize n) override
+		{
+			if (capture_target != nullptr)
+			{
+				capture_target->append(s, n);
+				return n;
+			}
+			return console->sputn(s, n);
+		}
+
+		int sync() override
+		{
+			return capture_target != nullptr ? 0 : console->pubsync();
+		}
+	};
+}
+
+void OutputCapture::install()
+{
+	static CaptureBuffer buffer(std::cout.rdbuf());
+	if (std::cout.rdbuf() != &buffer)
+	{
+		std::cout.rdbuf(&buffer);
+	}
+}
+
+OutputCapture::OutputCapture(std::string &buffer) : previous(capture_target)
+{
+	capture_target = &buffer;
+}
+
+OutputCapture::~OutputCapture()
+{
+	capture_target = previous;
+}
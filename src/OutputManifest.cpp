@@ -0,0 +1,198 @@
+#include <OutputManifest.hpp>
+#include <OutputWriter.hpp>
+#include <ParseCache.hpp>
+#include <SchemaCodec.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// modification time of path as a plain number, 0 if it does not exist
+static int64_t modificationTime(const std::filesystem::path &path)
+{
+	std::error_code ec;
+	auto time = std::filesystem::last_write_time(path, ec);
+	return ec ? 0 : (int64_t)time.time_since_epoch().count();
+}
+
+// a file name directly inside the directory, anything that could reach outside
+// of it is rejected so a damaged or hand edited manifest can not delete it
+static bool isPlainFileName(const std::string &name)
+{
+	if (name.empty() || name == "." || name == ".." || name == OutputManifest::file_name || name.find_first_of("/\\") != std::string::npos)
+	{
+		return false;
+	}
+	std::filesystem::path path(name);
+	return !path.has_root_path() && path.filename() == path;
+}
+
+OutputManifest &OutputManifest::instance()
+{
+	static OutputManifest manifest;
+	return manifest;
+}
+
+// the same directory reached through "out/Cpp" and "out/Cpp/" is one entry
+std::string OutputManifest::key(const std::string &directory_path)
+{
+	std::filesystem::path path = std::filesystem::path(directory_path).lexically_normal();
+	if (!path.has_filename() && path.has_parent_path())
+	{
+		path = path.parent_path();
+	}
+	return path.string();
+}
+
+OutputManifest::Directory &OutputManifest::directory(const std::string &path)
+{
+	auto it = directories.find(path);
+	if (it != directories.end())
+	{
+		return it->second;
+	}
+	Directory &dir = directories[path];
+	// the directory is created here so generators never touch the disk
+	std::error_code ec;
+	std::filesystem::create_directories(path, ec);
+	// one "<hash> <size> <mtime> <file name>" line per file, a missing or damaged
+	// manifest just means everything is written again
+	std::ifstream file(std::filesystem::path(path) / file_name);
+	std::string line;
+	while (std::getline(file, line))
+	{
+		std::istringstream fields(line);
+		Entry entry;
+		std::string name;
+		if (fields >> std::hex >> entry.hash >> std::dec >> entry.size >> entry.mtime && fields.get() == ' ' && std::getline(fields, name) && isPlainFileName(name))
+		{
+			dir.entries[name] = entry;
+		}
+	}
+	return dir;
+}
+
+void OutputManifest::write(const std::string &path, std::string data)
+{
+	std::filesystem::path file_path(path);
+	std::string directory_path = key(file_path.parent_path().string());
+	std::string name = file_path.filename().string();
+	Entry entry{ParseCache::hash(data), data.size()};
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		Directory &dir = directory(directory_path);
+		dir.produced.insert(name);
+		auto it = dir.entries.find(name);
+		// only trust the manifest while the file is still the one written
+		if (it != dir.entries.end() && it->second.hash == entry.hash && it->second.size == entry.size &&
+			it->second.mtime != 0 && it->second.mtime == modificationTime(file_path))
+		{
+			unchanged++;
+			if (verbose)
+			{
+				std::cout << "Unchanged file: " << path << "\n";
+			}
+			return;
+		}
+	}
+	if (verbose)
+	{
+		std::cout << "Generated file: " << path << "\n";
+	}
+
+	// outside the lock, the writer may block until it has caught up
+	OutputWriter::instance().write(path, std::move(data), [this, file_path, directory_path, name, entry](bool ok) mutable
+								   {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!ok)
+		{
+			failed.push_back(file_path.string());
+			return;
+		}
+		entry.mtime = modificationTime(file_path);
+		Directory &dir = directory(directory_path);
+		dir.entries[name] = entry;
+		dir.changed = true;
+		written++; });
+}
+
+void OutputManifest::complete(const std::string &directory_path)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	directory(key(directory_path)).complete = true;
+}
+
+bool OutputManifest::save(OutputTotals &totals)
+{
+	OutputWriter::instance().wait();
+	std::lock_guard<std::mutex> lock(mutex);
+	for (const auto &path : failed)
+	{
+		std::cout << "Failed to write file: " << path << std::endl;
+	}
+	totals = {written, unchanged, failed.size()};
+	bool ok = failed.empty();
+	written = 0;
+	unchanged = 0;
+	failed.clear();
+
+	for (auto &[path, dir] : directories)
+	{
+		if (dir.complete)
+		{
+			for (auto it = dir.entries.begin(); it != dir.entries.end();)
+			{
+				if (dir.produced.count(it->first) != 0)
+				{
+					++it;
+					continue;
+				}
+				std::filesystem::path stale = std::filesystem::path(path) / it->first;
+				std::error_code ec;
+				// entries are checked when read, this keeps the removal inside path regardless
+				if (!isPlainFileName(it->first) || stale.lexically_normal().parent_path() != std::filesystem::path(path).lexically_normal())
+				{
+					it = dir.entries.erase(it);
+					dir.changed = true;
+					continue;
+				}
+				std::filesystem::remove(stale, ec);
+				if (ec)
+				{
+					// stays in the manifest so the next run tries again
+					std::cout << "Failed to remove stale file: " << stale.string() << std::endl;
+					ok = false;
+					++it;
+					continue;
+				}
+				if (verbose)
+				{
+					std::cout << "Removed stale file: " << stale.string() << "\n";
+				}
+				totals.removed++;
+				it = dir.entries.erase(it);
+				dir.changed = true;
+			}
+		}
+		dir.produced.clear();
+		dir.complete = false;
+
+		if (!dir.changed)
+		{
+			continue;
+		}
+		std::ostringstream out;
+		for (const auto &[name, entry] : dir.entries)
+		{
+			out << std::hex << entry.hash << std::dec << " " << entry.size << " " << entry.mtime << " " << name << "\n";
+		}
+		if (!writeFileAtomically((std::filesystem::path(path) / file_name).string(), out.str()))
+		{
+			std::cout << "Failed to write file: " << (std::filesystem::path(path) / file_name).string() << std::endl;
+			ok = false;
+			continue;
+		}
+		dir.changed = false;
+	}
+	return ok;
+}
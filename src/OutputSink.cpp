@@ -0,0 +1,147 @@
+#include <OutputSink.hpp>
+#include <OutputManifest.hpp>
+#include <SchemaCodec.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+void FileSystemSink::write(const std::string &path, std::string data)
+{
+	OutputManifest::instance().write(path, std::move(data));
+}
+
+void FileSystemSink::complete(const std::string &directory_path)
+{
+	OutputManifest::instance().complete(directory_path);
+}
+
+bool FileSystemSink::finish(OutputTotals &totals)
+{
+	return OutputManifest::instance().save(totals);
+}
+
+void MemorySink::write(const std::string &path, std::string data)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	files[path] = std::move(data);
+	written++;
+}
+
+bool MemorySink::finish(OutputTotals &totals)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	totals = OutputTotals();
+	totals.written = written;
+	written = 0;
+	return true;
+}
+
+std::string ArchiveSink::entryName(const std::string &path) const
+{
+	std::filesystem::path relative = std::filesystem::path(path).lexically_relative(root);
+	// files outside root keep their own path, without a leading '/'
+	return relative.empty() || *relative.begin() == ".." ? std::filesystem::path(path).relative_path().generic_string() : relative.generic_string();
+}
+
+void ArchiveSink::write(const std::string &path, std::string data)
+{
+	std::string name = entryName(path);
+	std::lock_guard<std::mutex> lock(mutex);
+	written.insert(name);
+	files[name] = std::move(data);
+}
+
+void ArchiveSink::complete(const std::string &directory_path)
+{
+	std::string name = entryName(directory_path);
+	std::lock_guard<std::mutex> lock(mutex);
+	completed.push_back(name == "." ? "" : name + "/");
+}
+
+// one 512 byte ustar header, numbers are octal and zero terminated
+static void appendTarHeader(std::string &out, const std::string &name, size_t size, char type)
+{
+	char header[512];
+	memset(header, 0, sizeof(header));
+	memcpy(header, name.data(), std::min<size_t>(name.size(), 100));
+	snprintf(header + 100, 8, "%07o", 0644);
+	snprintf(header + 108, 8, "%07o", 0);
+	snprintf(header + 116, 8, "%07o", 0);
+	snprintf(header + 124, 12, "%011llo", (unsigned long long)size);
+	snprintf(header + 136, 12, "%011o", 0);
+	header[156] = type;
+	memcpy(header + 257, "ustar", 6);
+	memcpy(header + 263, "00", 2);
+
+	// the checksum is taken with its own field filled with spaces
+	memset(header + 148, ' ', 8);
+	unsigned checksum = 0;
+	for (unsigned char c : header)
+	{
+		checksum += c;
+	}
+	snprintf(header + 148, 8, "%06o", checksum);
+	out.append(header, sizeof(header));
+}
+
+static void appendTarData(std::string &out, const std::string &data)
+{
+	out += data;
+	out.append((512 - data.size() % 512) % 512, '\0');
+}
+
+bool ArchiveSink::finish(OutputTotals &totals)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	totals = OutputTotals();
+	// entries a completed directory did not write again belong to removed definitions
+	for (auto it = files.begin(); it != files.end();)
+	{
+		bool stale = written.count(it->first) == 0 && std::any_of(completed.begin(), completed.end(), [&](const std::string &prefix)
+																   { return it->first.compare(0, prefix.size(), prefix) == 0; });
+		if (stale)
+		{
+			it = files.erase(it);
+			totals.removed++;
+		}
+		else
+		{
+			++it;
+		}
+	}
+	completed.clear();
+
+	std::string out;
+	for (const auto &[name, data] : files)
+	{
+		// names that do not fit the header go into a GNU long name entry first
+		if (name.size() >= 100)
+		{
+			appendTarHeader(out, "././@LongLink", name.size() + 1, 'L');
+			appendTarData(out, name + '\0');
+		}
+		appendTarHeader(out, name, data.size(), '0');
+		appendTarData(out, data);
+	}
+	out.append(1024, '\0');
+
+	std::error_code ec;
+	std::filesystem::path parent = std::filesystem::path(archive_path).parent_path();
+	if (!parent.empty())
+	{
+		std::filesystem::create_directories(parent, ec);
+	}
+	if (!writeFileAtomically(archive_path, out))
+	{
+		std::cout << "Failed to write file: " << archive_path << std::endl;
+		totals.failed = written.size();
+		written.clear();
+		return false;
+	}
+	totals.written = written.size();
+	totals.unchanged = files.size() - written.size();
+	written.clear();
+	return true;
+}
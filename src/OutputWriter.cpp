@@ -0,0 +1,67 @@
+#include <OutputWriter.hpp>
+#include <SchemaCodec.hpp>
+
+OutputWriter::OutputWriter() : thread(&OutputWriter::run, this)
+{
+}
+
+OutputWriter::~OutputWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	queued.notify_one();
+	thread.join();
+}
+
+OutputWriter &OutputWriter::instance()
+{
+	static OutputWriter writer;
+	return writer;
+}
+
+void OutputWriter::run()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		queued.wait(lock, [&]
+					{ return stopping || !jobs.empty(); });
+		// files still queued at exit are written before the thread ends
+		if (jobs.empty())
+		{
+			return;
+		}
+		Job job = std::move(jobs.front());
+		jobs.pop_front();
+		busy = true;
+		lock.unlock();
+
+		bool ok = writeFileAtomically(job.path, job.data);
+		job.done(ok);
+
+		lock.lock();
+		busy = false;
+		queued_bytes -= job.data.size();
+		progress.notify_all();
+	}
+}
+
+void OutputWriter::write(std::string path, std::string data, std::function<void(bool ok)> done)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	// a single file larger than the limit still goes through once the queue is empty
+	progress.wait(lock, [&]
+				  { return queued_bytes == 0 || queued_bytes + data.size() <= max_queued_bytes; });
+	queued_bytes += data.size();
+	jobs.push_back({std::move(path), std::move(data), std::move(done)});
+	queued.notify_one();
+}
+
+void OutputWriter::wait()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	progress.wait(lock, [&]
+				  { return jobs.empty() && !busy; });
+}
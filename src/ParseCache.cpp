@@ -0,0 +1,216 @@
+#include <ParseCache.hpp>
+#include <ProgramStructure.hpp>
+#include <SchemaCodec.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+static const char cache_magic[4] = {'S', 'L', 'P', 'C'};
+static const uint32_t cache_format = 2;
+
+uint64_t ParseCache::fingerprint(const StructDefinition &s)
+{
+	CacheWriter w;
+	if (!write_struct(w, s))
+	{
+		// generator content is not part of a parsed definition, fall back to its name
+		return hash(s.getIdentifier());
+	}
+	return hash(w.out);
+}
+
+uint64_t ParseCache::fingerprint(const EnumDefinition &e)
+{
+	CacheWriter w;
+	write_enum(w, e);
+	return hash(w.out);
+}
+
+uint64_t ParseCache::hash(std::string_view data, uint64_t seed)
+{
+	uint64_t h = seed;
+	for (unsigned char c : data)
+	{
+		h ^= c;
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+std::string ParseCache::entryPath(const std::string &file_path, std::string_view contents) const
+{
+	uint64_t key = hash(version);
+	key = hash(file_path, key ^ 0xff);
+	key = hash(contents, key ^ 0xff);
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+	return (std::filesystem::path(directory) / name).string();
+}
+
+bool ParseCache::loadFromDisk(const std::string &file_path, std::string_view contents, FileParse &parse) const
+{
+	std::ifstream file(entryPath(file_path, contents), std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+	std::string data = buffer.str();
+
+	CacheReader r;
+	r.in = data;
+	char magic[4];
+	if (!r.take(magic, sizeof(magic)) || memcmp(magic, cache_magic, sizeof(magic)) != 0 || r.u32() != cache_format)
+	{
+		return false;
+	}
+	// the key is only a hash, confirm the entry really is for this input
+	if (r.str() != version || r.str() != file_path || r.u64() != contents.size() || r.u64() != hash(contents) || !r.ok)
+	{
+		return false;
+	}
+
+	FileParse result;
+	result.type_names = read_strings(r);
+	result.struct_names = read_strings(r);
+	result.include_candidates = read_strings(r);
+	for (uint32_t i = 0, n = r.count(); i < n && r.ok; i++)
+	{
+		FileParse::Item item;
+		item.kind = (FileParse::ItemKind)r.u8();
+		item.index = r.u32();
+		result.items.push_back(item);
+	}
+	for (uint32_t i = 0, n = r.count(); i < n && r.ok; i++)
+	{
+		FileParse::Include include;
+		include.path = r.str();
+		include.absolute = r.u8();
+		// the token text is not kept, its index still finds it once the file is lexed
+		include.token.position.file_id = FileTable::instance().intern(file_path);
+		include.token.position.line = r.i32();
+		include.token.position.column = r.i32();
+		include.token.index = r.i32();
+		result.includes.push_back(include);
+	}
+	for (uint32_t i = 0, n = r.count(); i < n && r.ok; i++)
+	{
+		read_struct(r, result.structs.emplace_back());
+		read_positions(r, result.structs.back());
+	}
+	for (uint32_t i = 0, n = r.count(); i < n && r.ok; i++)
+	{
+		read_enum(r, result.enums.emplace_back());
+	}
+	if (!r.ok || r.pos != r.in.size())
+	{
+		return false;
+	}
+
+	// item indices come from disk, check them before anything trusts them
+	for (const auto &item : result.items)
+	{
+		size_t limit = item.kind == FileParse::INCLUDE ? result.includes.size() : item.kind == FileParse::STRUCT ? result.structs.size() : item.kind == FileParse::ENUM ? result.enums.size() : 0;
+		if (item.index >= limit)
+		{
+			return false;
+		}
+	}
+	parse = std::move(result);
+	return true;
+}
+
+bool ParseCache::storeToDisk(const std::string &file_path, std::string_view contents, const FileParse &parse) const
+{
+	CacheWriter w;
+	w.out.append(cache_magic, sizeof(cache_magic));
+	w.u32(cache_format);
+	w.str(version);
+	w.str(file_path);
+	w.u64(contents.size());
+	w.u64(hash(contents));
+
+	w.strings(parse.type_names);
+	w.strings(parse.struct_names);
+	w.strings(parse.include_candidates);
+	w.u32((uint32_t)parse.items.size());
+	for (const auto &item : parse.items)
+	{
+		w.u8((uint8_t)item.kind);
+		w.u32((uint32_t)item.index);
+	}
+	w.u32((uint32_t)parse.includes.size());
+	for (const auto &include : parse.includes)
+	{
+		w.str(include.path);
+		w.u8(include.absolute);
+		w.i32(include.token.position.line);
+		w.i32(include.token.position.column);
+		w.i32(include.token.index);
+	}
+	w.u32((uint32_t)parse.structs.size());
+	for (const auto &s : parse.structs)
+	{
+		if (!write_struct(w, s))
+		{
+			return false;
+		}
+		write_positions(w, s);
+	}
+	w.u32((uint32_t)parse.enums.size());
+	for (const auto &e : parse.enums)
+	{
+		write_enum(w, e);
+	}
+
+	// concurrent runs never see half written entries
+	std::error_code ec;
+	std::filesystem::create_directories(directory, ec);
+	return writeFileAtomically(entryPath(file_path, contents), w.out);
+}
+
+bool ParseCache::load(const std::string &file_path, std::string_view contents, FileParse &parse)
+{
+	if (keep_in_memory)
+	{
+		std::lock_guard<std::mutex> lock(memory_mutex);
+		auto it = memory.find(file_path);
+		if (it != memory.end() && it->second.size == contents.size() && it->second.hash == hash(contents))
+		{
+			parse = it->second.parse;
+			return true;
+		}
+	}
+	if (directory.empty() || !loadFromDisk(file_path, contents, parse))
+	{
+		return false;
+	}
+	if (keep_in_memory)
+	{
+		std::lock_guard<std::mutex> lock(memory_mutex);
+		memory[file_path] = MemoryEntry{contents.size(), hash(contents), parse};
+	}
+	return true;
+}
+
+bool ParseCache::store(const std::string &file_path, std::string_view contents, const FileParse &parse)
+{
+	if (keep_in_memory)
+	{
+		MemoryEntry entry{contents.size(), hash(contents), parse};
+		// token text points into the source buffer, which does not outlive this parse
+		for (auto &include : entry.parse.includes)
+		{
+			include.token.value = std::string_view();
+		}
+		std::lock_guard<std::mutex> lock(memory_mutex);
+		memory[file_path] = std::move(entry);
+	}
+	if (directory.empty())
+	{
+		return keep_in_memory;
+	}
+	return storeToDisk(file_path, contents, parse);
+}
@@ -1,9 +1,29 @@
 #include <ProgramStructure.hpp>
+#include <FileParse.hpp>
+#include <LexScan.hpp>
+#include <ParseCache.hpp>
+#include <ParallelFor.hpp>
+#include <SchemaCodec.hpp>
+#include <algorithm>
+#include <cstdarg>
+#include <cstring>
+#include <cstdint>
+#include <deque>
 
-bool ProgramStructure::isInt(std::string str)
+bool ProgramStructure::isInt(std::string_view str)
 {
-	std::regex int_regex("^[0-9]+$");
-	return std::regex_match(str, int_regex);
+	if (str.empty())
+	{
+		return false;
+	}
+	for (char c : str)
+	{
+		if (c < '0' || c > '9')
+		{
+			return false;
+		}
+	}
+	return true;
 }
 
 bool ProgramStructure::isBreakChar(std::string str)
@@ -13,7 +33,7 @@ bool ProgramStructure::isBreakChar(std::string str)
 
 bool ProgramStructure::isBreakChar(char c)
 {
-	return c == ' ' || c == '\n' || c == '\t';
+	return char_classes[c] == CHAR_BLANK || char_classes[c] == CHAR_NEWLINE;
 }
 
 bool ProgramStructure::isSpecialBreakChar(std::string c)
@@ -23,7 +43,32 @@ bool ProgramStructure::isSpecialBreakChar(std::string c)
 
 bool ProgramStructure::isSpecialBreakChar(char c)
 {
-	return c == '{' || c == '}' || c == '(' || c == ')' || c == ',' || c == ';' || c == ':' || c == '<' || c == '>' || c == '=' || c == '.';
+	return char_classes[c] == CHAR_SPECIAL;
+}
+
+void ProgramStructure::printDiagnostic(const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	if (diagnostics == nullptr)
+	{
+		vprintf(format, args);
+	}
+	else
+	{
+		va_list size_args;
+		va_copy(size_args, args);
+		int length = vsnprintf(nullptr, 0, format, size_args);
+		va_end(size_args);
+		if (length > 0)
+		{
+			size_t offset = diagnostics->size();
+			diagnostics->resize(offset + length + 1);
+			vsnprintf(&(*diagnostics)[offset], length + 1, format, args);
+			diagnostics->resize(offset + length);
+		}
+	}
+	va_end(args);
 }
 
 void ProgramStructure::reportError(const std::string &message)
@@ -33,96 +78,51 @@ void ProgramStructure::reportError(const std::string &message)
 
 void ProgramStructure::reportError(const std::string &message, const SourcePosition &position)
 {
-	printf("Error: %s:%d:%d: %s\n", position.file_path.c_str(), position.line, position.column, message.c_str());
+	reported_errors.push_back({position, 0, message});
+	printDiagnostic("Error: %s:%d:%d: %s\n", position.file_path().c_str(), position.line, position.column, message.c_str());
 }
 
 void ProgramStructure::reportError(const std::string &message, const Token &token)
 {
-	// Try to provide surrounding token context and source line with caret.
-	// Read the source file and attempt to find nearby tokens.
-	std::string file_path = token.position.file_path;
-	std::ifstream file(file_path);
-	if (!file.is_open())
-	{
-		// fallback to existing behavior
-		reportError(message, token.position);
-		return;
-	}
-
-	// Read whole file into a string
-	std::string whole_file((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-	file.close();
-
-	// Tokenize with position to reconstruct tokens and their positions
-	std::vector<Token> all_tokens = tokenizeWithPosition(whole_file, file_path);
-
-	// find index of the token (match by position.line and column and value)
-	int idx = -1;
-	for (int i = 0; i < (int)all_tokens.size(); ++i)
-	{
-		if (all_tokens[i].position.line == token.position.line && all_tokens[i].position.column == token.position.column && all_tokens[i].value == token.value)
-		{
-			idx = i;
-			break;
-		}
-	}
-
 	// Print the basic error header
 	reportError(message, token.position);
+	reported_errors.back().length = token.value.size();
 
-	if (idx == -1)
+	// Provide surrounding token context and the source line with a caret,
+	// both come straight from the buffer the token was lexed from
+	const SourceBuffer *buffer = source_manager->find(token.position.file_id);
+	if (buffer == nullptr || token.index < 0 || token.index >= (int)buffer->tokens.size())
 	{
-		// Couldn't find matching token; nothing more to show
+		// Token is not from a loaded file; nothing more to show
 		return;
 	}
+	const std::vector<Token> &all_tokens = buffer->tokens;
+	int idx = token.index;
 
 	// Print a few tokens around the error token
 	int context_radius = 3;
 	int start = std::max(0, idx - context_radius);
 	int end = std::min((int)all_tokens.size() - 1, idx + context_radius);
-	printf("Context tokens:\n");
+	printDiagnostic("Context tokens:\n");
 	for (int i = start; i <= end; ++i)
 	{
 		if (i == idx)
 		{
-			printf(" -> [%s]\n", all_tokens[i].value.c_str());
+			printDiagnostic(" -> [%.*s]\n", (int)all_tokens[i].value.size(), all_tokens[i].value.data());
 		}
 		else
 		{
-			printf("    %s\n", all_tokens[i].value.c_str());
+			printDiagnostic("    %.*s\n", (int)all_tokens[i].value.size(), all_tokens[i].value.data());
 		}
 	}
 
 	// Print the source line and show a caret under the offending token's column
-	// Find the line in the file
-	int line_no = token.position.line;
-	int cur_line = 1;
-	size_t pos = 0;
-	size_t line_start = 0;
-	size_t line_end = 0;
-	while (pos < whole_file.size())
-	{
-		if (cur_line == line_no)
-		{
-			line_start = pos;
-			// find end of line
-			while (pos < whole_file.size() && whole_file[pos] != '\n') pos++;
-			line_end = pos;
-			break;
-		}
-		if (whole_file[pos] == '\n')
-		{
-			cur_line++;
-		}
-		pos++;
-	}
-	if (line_end > line_start)
+	std::string_view line = SourceManager::line(*buffer, token.position.line);
+	if (!line.empty())
 	{
-		std::string line = whole_file.substr(line_start, line_end - line_start);
-		printf("%s\n", line.c_str());
+		printDiagnostic("%.*s\n", (int)line.size(), line.data());
 		// build caret line: columns in SourcePosition are 1-based
 		int caret_col = token.position.column - 1; // zero-based
-		// but the token may start later due to previous tokens; attempt to place caret at column
 		std::string caret;
 		for (int i = 0; i < caret_col && i < (int)line.size(); ++i)
 		{
@@ -132,77 +132,133 @@ void ProgramStructure::reportError(const std::string &message, const Token &toke
 				caret += ' ';
 		}
 		caret += '^';
-		printf("%s\n", caret.c_str());
+		printDiagnostic("%s\n", caret.c_str());
 	}
 }
 
-std::vector<Token> ProgramStructure::tokenizeWithPosition(std::string str, const std::string &file_path)
+std::vector<Token> ProgramStructure::tokenizeWithPosition(std::string_view str, const std::string &file_path)
 {
 	std::vector<Token> tokens;
-	std::string token_value = "";
 	SourcePosition position(file_path, 1, 1);
 	bool in_string = false;
 	bool skip_next = false;
 
+	// The current token is normally a contiguous slice of str. An escape drops
+	// characters from the middle of a token, only then is it copied into
+	// escaped_value and interned.
+	size_t token_begin = 0;
+	size_t token_length = 0;
+	bool token_escaped = false;
+	std::string escaped_value;
+
+	// adds str[idx, idx + length) to the current token
+	auto append_run = [&](size_t idx, size_t length)
+	{
+		if (token_escaped)
+		{
+			escaped_value.append(str.substr(idx, length));
+		}
+		else if (token_length == 0)
+		{
+			token_begin = idx;
+			token_length = length;
+		}
+		else if (token_begin + token_length == idx)
+		{
+			token_length += length;
+		}
+		else
+		{
+			escaped_value.assign(str.substr(token_begin, token_length));
+			escaped_value.append(str.substr(idx, length));
+			token_escaped = true;
+		}
+	};
+	// identifiers and escaped strings are interned, string literals stay slices of the source
+	auto emit_token = [&](bool string_literal)
+	{
+		if (token_escaped)
+		{
+			if (!escaped_value.empty())
+			{
+				tokens.emplace_back(interner->intern(escaped_value), position, (int)tokens.size());
+			}
+		}
+		else if (token_length > 0)
+		{
+			std::string_view value = str.substr(token_begin, token_length);
+			tokens.emplace_back(string_literal ? value : interner->intern(value), position, (int)tokens.size());
+		}
+		token_length = 0;
+		token_escaped = false;
+		escaped_value.clear();
+	};
+	// moves position over str[from, to), which contains line breaks only where they count as lines
+	auto advance_lines = [&](size_t from, size_t to)
+	{
+		size_t last_newline = std::string_view::npos;
+		for (size_t i = from; i < to; i++)
+		{
+			const char *newline = static_cast<const char *>(memchr(str.data() + i, '\n', to - i));
+			if (newline == nullptr)
+			{
+				break;
+			}
+			last_newline = newline - str.data();
+			position.line++;
+			i = last_newline;
+		}
+		if (last_newline == std::string_view::npos)
+		{
+			position.column += to - from;
+		}
+		else
+		{
+			position.column = 1 + (to - last_newline - 1);
+		}
+	};
+
 	for (size_t idx = 0; idx < str.size();)
 	{
 		char c = str[idx];
+		CharClass char_class = char_classes[c];
 		char next = (idx + 1 < str.size() ? str[idx + 1] : '\0');
 
 		// handle comment starts (only when not inside a string)
-		if (!in_string && c == '/' && next == '/')
+		if (!in_string && char_class == CHAR_SLASH && next == '/')
 		{
 			// single-line comment: skip until newline (or EOF)
-			idx += 2;
-			position.column += 2;
-			while (idx < str.size() && str[idx] != '\n')
+			const char *newline = static_cast<const char *>(memchr(str.data() + idx, '\n', str.size() - idx));
+			if (newline == nullptr)
 			{
-				idx++;
-				position.column++;
+				position.column += str.size() - idx;
+				idx = str.size();
 			}
-			if (idx < str.size() && str[idx] == '\n')
+			else
 			{
 				position.line++;
 				position.column = 1;
-				idx++;
+				idx = newline - str.data() + 1;
 			}
 			continue;
 		}
-		if (!in_string && c == '/' && next == '*')
+		if (!in_string && char_class == CHAR_SLASH && next == '*')
 		{
 			// multi-line comment: skip until '*/'
-			idx += 2;
-			position.column += 2;
-			bool found_end = false;
-			while (idx < str.size())
-			{
-				if (str[idx] == '\n')
-				{
-					position.line++;
-					position.column = 1;
-					idx++;
-					continue;
-				}
-				if (str[idx] == '*' && idx + 1 < str.size() && str[idx + 1] == '/')
-				{
-					idx += 2;
-					position.column += 2;
-					found_end = true;
-					break;
-				}
-				idx++;
-				position.column++;
-			}
-			if (!found_end)
+			size_t end = str.find("*/", idx + 2);
+			if (end == std::string_view::npos)
 			{
 				// Unterminated comment — report and stop tokenizing
+				advance_lines(idx, str.size());
 				reportError("Unterminated block comment", position);
 				return tokens;
 			}
+			advance_lines(idx, end + 2);
+			idx = end + 2;
 			continue;
 		}
 
-		if (c == '\\')
+		if (char_class == CHAR_ESCAPE)
 		{
 			// preserve previous behavior: skip next char (escape)
 			skip_next = true;
@@ -218,65 +274,58 @@ std::vector<Token> ProgramStructure::tokenizeWithPosition(std::string str, const
 			continue;
 		}
 
-		if (c == '"')
+		if (char_class == CHAR_QUOTE)
 		{
 			in_string = !in_string;
 			if (!in_string)
 			{
 				// end of string, emit token
-				tokens.emplace_back(token_value, position);
-				token_value.clear();
+				emit_token(true);
 			}
 			position.column++;
 			idx++;
 			continue;
 		}
-		if (!in_string)
+
+		size_t length = 1;
+		if (in_string)
 		{
-			if ((isBreakChar(c) || isSpecialBreakChar(c)))
-			{
-				if (!token_value.empty())
-				{
-					tokens.emplace_back(token_value, position);
-					token_value.clear();
-				}
-				if (isSpecialBreakChar(c))
-				{
-					tokens.emplace_back(std::string(1, c), position);
-				}
-				if (c == '\n')
-				{
-					position.line++;
-					position.column = 1;
-				}
-				else
-				{
-					position.column++;
-				}
-				idx++;
-				continue;
-			}
+			// everything up to the closing quote or the next escape, line breaks included
+			length = scanStringBody(str.data() + idx, str.size() - idx);
 		}
-		token_value += c;
-		position.column++;
-		idx++;
-	}
-	if (!token_value.empty())
-	{
-		tokens.emplace_back(token_value, position);
-	}
-	// remove empty tokens
-	for (auto it = tokens.begin(); it != tokens.end();)
-	{
-		if (it->value.empty())
+		else if (char_class == CHAR_BLANK)
 		{
-			it = tokens.erase(it);
+			emit_token(false);
+			length = scanBlanks(str.data() + idx, str.size() - idx);
+			position.column += length;
+			idx += length;
+			continue;
+		}
+		else if (char_class == CHAR_NEWLINE)
+		{
+			emit_token(false);
+			position.line++;
+			position.column = 1;
+			idx++;
+			continue;
+		}
+		else if (char_class == CHAR_SPECIAL)
+		{
+			emit_token(false);
+			tokens.emplace_back(str.substr(idx, 1), position, (int)tokens.size());
+			position.column++;
+			idx++;
+			continue;
 		}
 		else
 		{
-			++it;
+			length = std::max<size_t>(1, scanIdentifier(str.data() + idx, str.size() - idx));
 		}
+		append_run(idx, length);
+		position.column += length;
+		idx += length;
 	}
+	emit_token(in_string);
 	return tokens;
 }
 
@@ -391,340 +440,308 @@ std::vector<std::string> ProgramStructure::tokenize(std::string str)
 	return tokens;
 }
 
-bool ProgramStructure::readMemberVariable(std::vector<Token> tokens, int &i, MemberVariableDefinition &current_MemberVariableDefinition)
+bool ProgramStructure::writeEmptyInitializer(ProgramStructure * /*ps*/, MemberVariableDefinition & /*mv*/, std::ostream &structFile)
 {
-	std::vector<Token> member_variable_tokens;
-	if (tokenIsValidTypeName(tokens[i].value))
-	{
-		// collect the type
-		current_MemberVariableDefinition.type.identifier() = tokens[i].value;
-		i++;
-		// if array
-		if (current_MemberVariableDefinition.type.is_array())
-		{
-			// check for '<'
-			if (tokens[i] == "<")
-			{
-				i++;
-				if (tokenIsValidTypeName(tokens[i].value))
-				{
-					current_MemberVariableDefinition.type.element_type().identifier() = tokens[i].value;
-					current_MemberVariableDefinition.generate_initializer = [](ProgramStructure *ps, MemberVariableDefinition &mv, std::ofstream &structFile) -> bool
-					{
-						structFile << "{}";
-						return true;
-					};
-					current_MemberVariableDefinition.in_class_init = true;
-				}
-				else
-				{
-					reportError("Expected array element type for " + tokens[i + 3].value, tokens[i]);
-					return false;
-				}
-				i++;
-				// check for '>'
-				if (tokens[i] != ">")
-				{
-					reportError("Expected '>' after array type " + current_MemberVariableDefinition.type.element_type().identifier() + " for " + current_MemberVariableDefinition.identifier, tokens[i]);
-					return false;
-				}
-				i++;
-			}
-		}
+	structFile << "{}";
+	return true;
+}
 
-		// check for ':'
-		if (tokens[i] != ":")
-		{
-			reportError("Expected ':' after member variable type " + current_MemberVariableDefinition.type.identifier(), tokens[i]);
-			return false;
-		}
-		i++;
-		// collect the identifier
-		current_MemberVariableDefinition.identifier = tokens[i].value;
-		i++;
-		// check for ':'
-		if (tokens[i] != ":")
-		{
-			reportError("Expected ':' after member variable identifier " + current_MemberVariableDefinition.identifier, tokens[i]);
-			return false;
-		}
-		i++;
-		// collect all tokens for member variable up to ';'
-		bool next_token_should_be_colon = false;
-		while (tokens[i] != ";")
+bool ProgramStructure::readMemberVariable(TokenStream &tokens, MemberVariableDefinition &current_MemberVariableDefinition)
+{
+	if (!tokenIsValidTypeName(tokens.peek().value))
+	{
+		reportError("Expected member variable type After {", tokens.peek());
+		return false;
+	}
+	// collect the type
+	current_MemberVariableDefinition.position = tokens.peek().position;
+	current_MemberVariableDefinition.type.setIdentifier(tokens.next().value);
+	// if array
+	if (current_MemberVariableDefinition.type.is_array())
+	{
+		// check for '<'
+		if (tokens.accept("<"))
 		{
-			if (tokens[i] != ":")
+			if (tokenIsValidTypeName(tokens.peek().value))
 			{
-				member_variable_tokens.push_back(tokens[i]);
-				next_token_should_be_colon = true;
+				current_MemberVariableDefinition.type.setElementType(TypeDefinition(tokens.peek().value));
+				current_MemberVariableDefinition.generate_initializer = writeEmptyInitializer;
+				current_MemberVariableDefinition.in_class_init = true;
 			}
 			else
 			{
-				if (!next_token_should_be_colon)
-				{
-					reportError("Unexpected ':' after " + current_MemberVariableDefinition.identifier, tokens[i]);
-					return false;
-				}
-				else
-				{
-					next_token_should_be_colon = false;
-				}
-			}
-			i++;
-		}
-		i++;
-		// parse member variable tokens
-		for (int j = 0; j < member_variable_tokens.size(); j++)
-		{
-			if (member_variable_tokens[j] == "required")
-			{
-				current_MemberVariableDefinition.required = true;
-			}
-			else if (member_variable_tokens[j] == "optional")
-			{
-				current_MemberVariableDefinition.required = false;
-			}
-			else if (member_variable_tokens[j] == "unique")
-			{
-				current_MemberVariableDefinition.unique = true;
-			}
-			else if (member_variable_tokens[j] == "auto_increment")
-			{
-				current_MemberVariableDefinition.auto_increment = true;
-			}
-			else if (member_variable_tokens[j] == "primary_key")
-			{
-				current_MemberVariableDefinition.primary_key = true;
-			}
-			else if (member_variable_tokens[j] == "min_items")
-			{
-				j++;
-				if (member_variable_tokens[j] != "(")
-				{
-					reportError("Expected '(' after min_items", member_variable_tokens[j]);
-					return false;
-				}
-				j++;
-				if (!isInt(member_variable_tokens[j].value))
-				{
-					reportError("Expected number after min_items(", member_variable_tokens[j]);
-					return false;
-				}
-				current_MemberVariableDefinition.min_items = std::stoi(member_variable_tokens[j].value);
-				j++;
-				if (member_variable_tokens[j] != ")")
-				{
-					reportError("Expected ')' after min_items number", member_variable_tokens[j]);
-					return false;
-				}
-			}
-			else if (member_variable_tokens[j] == "max_items")
-			{
-				j++;
-				if (member_variable_tokens[j] != "(")
-				{
-					reportError("Expected '(' after max_items", member_variable_tokens[j]);
-					return false;
-				}
-				j++;
-				if (!isInt(member_variable_tokens[j].value))
-				{
-					reportError("Expected number after max_items(", member_variable_tokens[j]);
-					return false;
-				}
-				current_MemberVariableDefinition.max_items = std::stoi(member_variable_tokens[j].value);
-				j++;
-				if (member_variable_tokens[j] != ")")
-				{
-					reportError("Expected ')' after max_items number", member_variable_tokens[j]);
-					return false;
-				}
-			}
-			else if (member_variable_tokens[j] == "reference")
-			{
-				if (tokenIsStruct(current_MemberVariableDefinition.type.identifier())&&member_variable_tokens[j+1] != "(")
-				{
-					current_MemberVariableDefinition.reference.struct_name = current_MemberVariableDefinition.type.identifier();
-				}
-				else
-				{
-					j++;
-					if (member_variable_tokens[j] != "(")
-					{
-						reportError("Expected '(' after reference", member_variable_tokens[j]);
-						return false;
-					}
-					j++;
-					current_MemberVariableDefinition.reference.struct_name = member_variable_tokens[j].value;
-					j++;
-					if (member_variable_tokens[j] != ".")
-					{
-						reportError("Expected '.' after reference struct name", member_variable_tokens[j]);
-						return false;
-					}
-					j++;
-					current_MemberVariableDefinition.reference.variable_name = member_variable_tokens[j].value;
-					j++;
-					if (member_variable_tokens[j] != ")")
-					{
-						reportError("Expected ')' after reference member variable name", member_variable_tokens[j]);
-						return false;
-					}
-				}
-			}
-			else if (member_variable_tokens[j] == "description")
-			{
-				j++;
-				if (member_variable_tokens[j] != "(")
-				{
-					reportError("Expected '(' after description", member_variable_tokens[j]);
-					return false;
-				}
-				j++;
-				current_MemberVariableDefinition.description = member_variable_tokens[j].value;
-				j++;
-				if (member_variable_tokens[j] != ")")
-				{
-					reportError("Expected ')' after description", member_variable_tokens[j]);
-					return false;
-				}
-			}
-			else if (member_variable_tokens[j] == "gens_enabled")
-			{
-				j++;
-				if (member_variable_tokens[j] != "(")
-				{
-					reportError("Expected '(' after gens_enabled", member_variable_tokens[j]);
-					return false;
-				}
-				do
-				{
-					j++;
-					current_MemberVariableDefinition.enabled_for_generators.insert(member_variable_tokens[j]);
-					j++;
-				} while (member_variable_tokens[j] == ",");
-				if (member_variable_tokens[j] != ")")
-				{
-					reportError("Expected ')' after gens_enabled", member_variable_tokens[j]);
-					return false;
-				}
-			}
-			else if (member_variable_tokens[j] == "gens_disabled")
-			{
-				j++;
-				if (member_variable_tokens[j] != "(")
-				{
-					reportError("Expected '(' after gens_disabled", member_variable_tokens[j]);
-					return false;
-				}
-				do
-				{
-					j++;
-					current_MemberVariableDefinition.disabled_for_generators.insert(member_variable_tokens[j]);
-					j++;
-				} while (member_variable_tokens[j] == ",");
-				if (member_variable_tokens[j] != ")")
-				{
-					reportError("Expected ')' after gens_disabled", member_variable_tokens[j]);
-					return false;
-				}
+				reportError("Expected array element type for " + tokens.peek(3).str(), tokens.peek());
+				return false;
 			}
-			else
+			tokens.advance();
+			// check for '>'
+			if (!tokens.accept(">"))
 			{
-				reportError("Unexpected token " + member_variable_tokens[j].value + " after " + current_MemberVariableDefinition.identifier, member_variable_tokens[j]);
+				reportError("Expected '>' after array type " + current_MemberVariableDefinition.type.element_type().identifier() + " for " + current_MemberVariableDefinition.identifier, tokens.peek());
 				return false;
 			}
 		}
 	}
-	else
+
+	// check for ':'
+	if (!tokens.accept(":"))
 	{
-		reportError("Expected member variable type After {", tokens[i]);
+		reportError("Expected ':' after member variable type " + current_MemberVariableDefinition.type.identifier(), tokens.peek());
 		return false;
 	}
-	return true;
-}
-
-bool ProgramStructure::readStruct(std::vector<Token> tokens, int &i, StructDefinition &current_struct)
-{
-	if (tokens[i] != "struct")
+	// collect the identifier
+	current_MemberVariableDefinition.identifier = tokens.next().value;
+	// check for ':'
+	if (!tokens.accept(":"))
 	{
-		reportError("Expected 'struct' keyword", tokens[i]);
+		reportError("Expected ':' after member variable identifier " + current_MemberVariableDefinition.identifier, tokens.peek());
 		return false;
 	}
-	i++;
-	current_struct.setIdentifier(tokens[i].value);
-	i++;
-	if (tokens[i] == ":")
+	// read the ':' separated modifiers up to ';'
+	bool next_token_should_be_colon = false;
+	while (!tokens.accept(";"))
 	{
-		i++;
-		if (tokens[i] == "gens_enabled")
+		if (tokens.atEnd())
 		{
-			i++;
-			if (tokens[i] != "(")
-			{
-				reportError("Expected '(' after gens_enabled", tokens[i]);
-				return false;
-			}
-			do
-			{
-				i++;
-				current_struct.add_gen_enabled(tokens[i]);
-				i++;
-			} while (tokens[i] == ",");
-			if (tokens[i] != ")")
-			{
-				reportError("Expected ')' after gens_enabled", tokens[i]);
-				return false;
-			}
-			i++;
+			reportError("Expected ';' after member variable " + current_MemberVariableDefinition.identifier, tokens.peek());
+			return false;
 		}
-		else if (tokens[i] == "gens_disabled")
+		if (tokens.peek() == ":")
 		{
-			i++;
-			if (tokens[i] != "(")
-			{
-				reportError("Expected '(' after gens_disabled", tokens[i]);
-				return false;
-			}
-			do
+			if (!next_token_should_be_colon)
 			{
-				i++;
-				current_struct.add_gen_disabled(tokens[i]);
-				i++;
-			} while (tokens[i] == ",");
-			if (tokens[i] != ")")
-			{
-				reportError("Expected ')' after gens_disabled", tokens[i]);
+				reportError("Unexpected ':' after " + current_MemberVariableDefinition.identifier, tokens.peek());
+				return false;
+			}
+			next_token_should_be_colon = false;
+			tokens.advance();
+			continue;
+		}
+		if (!readMemberVariableModifier(tokens, current_MemberVariableDefinition))
+		{
+			return false;
+		}
+		next_token_should_be_colon = true;
+	}
+	return true;
+}
+
+bool ProgramStructure::readMemberVariableModifier(TokenStream &tokens, MemberVariableDefinition &current_MemberVariableDefinition)
+{
+	const Token &modifier = tokens.next();
+	if (modifier == "required")
+	{
+		current_MemberVariableDefinition.required = true;
+	}
+	else if (modifier == "optional")
+	{
+		current_MemberVariableDefinition.required = false;
+	}
+	else if (modifier == "unique")
+	{
+		current_MemberVariableDefinition.unique = true;
+	}
+	else if (modifier == "auto_increment")
+	{
+		current_MemberVariableDefinition.auto_increment = true;
+	}
+	else if (modifier == "primary_key")
+	{
+		current_MemberVariableDefinition.primary_key = true;
+	}
+	else if (modifier == "min_items")
+	{
+		if (!tokens.accept("("))
+		{
+			reportError("Expected '(' after min_items", tokens.peek());
+			return false;
+		}
+		if (!isInt(tokens.peek().value))
+		{
+			reportError("Expected number after min_items(", tokens.peek());
+			return false;
+		}
+		current_MemberVariableDefinition.min_items = std::stoi(tokens.next().str());
+		if (!tokens.accept(")"))
+		{
+			reportError("Expected ')' after min_items number", tokens.peek());
+			return false;
+		}
+	}
+	else if (modifier == "max_items")
+	{
+		if (!tokens.accept("("))
+		{
+			reportError("Expected '(' after max_items", tokens.peek());
+			return false;
+		}
+		if (!isInt(tokens.peek().value))
+		{
+			reportError("Expected number after max_items(", tokens.peek());
+			return false;
+		}
+		current_MemberVariableDefinition.max_items = std::stoi(tokens.next().str());
+		if (!tokens.accept(")"))
+		{
+			reportError("Expected ')' after max_items number", tokens.peek());
+			return false;
+		}
+	}
+	else if (modifier == "reference")
+	{
+		bool type_is_struct = tokenIsStruct(current_MemberVariableDefinition.type.identifier()) ||
+							  (known_struct_names != nullptr && known_struct_names->count(current_MemberVariableDefinition.type.identifier()) != 0);
+		if (type_is_struct && tokens.peek() != "(")
+		{
+			current_MemberVariableDefinition.reference.struct_name = current_MemberVariableDefinition.type.identifier();
+		}
+		else
+		{
+			if (!tokens.accept("("))
+			{
+				reportError("Expected '(' after reference", tokens.peek());
+				return false;
+			}
+			current_MemberVariableDefinition.reference.struct_name = tokens.next().value;
+			if (!tokens.accept("."))
+			{
+				reportError("Expected '.' after reference struct name", tokens.peek());
+				return false;
+			}
+			current_MemberVariableDefinition.reference.variable_name = tokens.next().value;
+			if (!tokens.accept(")"))
+			{
+				reportError("Expected ')' after reference member variable name", tokens.peek());
+				return false;
+			}
+		}
+	}
+	else if (modifier == "description")
+	{
+		if (!tokens.accept("("))
+		{
+			reportError("Expected '(' after description", tokens.peek());
+			return false;
+		}
+		current_MemberVariableDefinition.description = tokens.next().value;
+		if (!tokens.accept(")"))
+		{
+			reportError("Expected ')' after description", tokens.peek());
+			return false;
+		}
+	}
+	else if (modifier == "gens_enabled")
+	{
+		if (!tokens.accept("("))
+		{
+			reportError("Expected '(' after gens_enabled", tokens.peek());
+			return false;
+		}
+		do
+		{
+			current_MemberVariableDefinition.enabled_for_generators.insert(tokens.next());
+		} while (tokens.accept(","));
+		if (!tokens.accept(")"))
+		{
+			reportError("Expected ')' after gens_enabled", tokens.peek());
+			return false;
+		}
+	}
+	else if (modifier == "gens_disabled")
+	{
+		if (!tokens.accept("("))
+		{
+			reportError("Expected '(' after gens_disabled", tokens.peek());
+			return false;
+		}
+		do
+		{
+			current_MemberVariableDefinition.disabled_for_generators.insert(tokens.next());
+		} while (tokens.accept(","));
+		if (!tokens.accept(")"))
+		{
+			reportError("Expected ')' after gens_disabled", tokens.peek());
+			return false;
+		}
+	}
+	else
+	{
+		reportError("Unexpected token " + modifier.str() + " after " + current_MemberVariableDefinition.identifier, modifier);
+		return false;
+	}
+	return true;
+}
+
+bool ProgramStructure::readStruct(TokenStream &tokens, StructDefinition &current_struct)
+{
+	if (!tokens.accept("struct"))
+	{
+		reportError("Expected 'struct' keyword", tokens.peek());
+		return false;
+	}
+	current_struct.position = tokens.peek().position;
+	current_struct.setIdentifier(tokens.next().str());
+	if (tokens.accept(":"))
+	{
+		if (tokens.accept("gens_enabled"))
+		{
+			if (!tokens.accept("("))
+			{
+				reportError("Expected '(' after gens_enabled", tokens.peek());
+				return false;
+			}
+			do
+			{
+				current_struct.add_gen_enabled(tokens.next());
+			} while (tokens.accept(","));
+			if (!tokens.accept(")"))
+			{
+				reportError("Expected ')' after gens_enabled", tokens.peek());
+				return false;
+			}
+		}
+		else if (tokens.accept("gens_disabled"))
+		{
+			if (!tokens.accept("("))
+			{
+				reportError("Expected '(' after gens_disabled", tokens.peek());
+				return false;
+			}
+			do
+			{
+				current_struct.add_gen_disabled(tokens.next());
+			} while (tokens.accept(","));
+			if (!tokens.accept(")"))
+			{
+				reportError("Expected ')' after gens_disabled", tokens.peek());
 				return false;
 			}
-			i++;
 		}
 		else
 		{
-			reportError("Invalid struct modifier", tokens[i]);
+			reportError("Invalid struct modifier", tokens.peek());
 			return false;
 		}
 	}
-	if (tokens[i] != "{")
+	if (!tokens.accept("{"))
 	{
-		reportError("Expected '{' after struct identifier", tokens[i]);
+		reportError("Expected '{' after struct identifier", tokens.peek());
 		return false;
 	}
-	i++;
-	while (tokens[i] != "}")
+	while (!tokens.accept("}"))
 	{
-		if (tokenIsValidTypeName(tokens[i].value))
+		if (tokenIsValidTypeName(tokens.peek().value))
 		{
 			MemberVariableDefinition current_MemberVariableDefinition;
-			if (!readMemberVariable(tokens, i, current_MemberVariableDefinition))
+			if (!readMemberVariable(tokens, current_MemberVariableDefinition))
 			{
 				return false;
 			}
-			current_struct.add_member_variable(current_MemberVariableDefinition);
+			current_struct.add_member_variable(std::move(current_MemberVariableDefinition));
 		}
 		else
 		{
-			reportError("Expected member variable type " + tokens[i].value + " is not a valid type for struct " + current_struct.getIdentifier() + " member variable " + tokens[i + 2].value, tokens[i]);
+			reportError("Expected member variable type " + tokens.peek().str() + " is not a valid type for struct " + current_struct.getIdentifier() + " member variable " + tokens.peek(2).str(), tokens.peek());
 			return false;
 		}
 	}
@@ -741,7 +758,7 @@ bool ProgramStructure::readStruct(std::vector<Token> tokens, int &i, StructDefin
 	}
 	if (has_id)
 	{
-		reportError("Struct " + current_struct.getIdentifier() + " can not have an 'id' member variable this is reserved for the primary key.");
+		reportError("Struct " + current_struct.getIdentifier() + " can not have an 'id' member variable this is reserved for the primary key.", current_struct.position);
 		return false;
 	}
 
@@ -754,47 +771,36 @@ bool ProgramStructure::readStruct(std::vector<Token> tokens, int &i, StructDefin
 	id_member.required = true;
 	id_member.unique = true;
 	id_member.description = "Primary unique identifier for " + current_struct.getIdentifier();
-	current_struct.add_member_variable(id_member);
+	id_member.position = current_struct.position;
+	current_struct.add_member_variable(std::move(id_member));
 
 	// remove identifier from type_names
-	auto it = std::find(type_names.begin(), type_names.end(), current_struct.getIdentifier());
-	if (it != type_names.end())
-	{
-		type_names.erase(it);
-	}
+	type_names.erase(current_struct.getIdentifier());
 	return true;
 }
 
-bool ProgramStructure::readEnumValue(std::vector<Token> tokens, int &i, EnumDefinition &current_enum, int &curent_index)
+bool ProgramStructure::readEnumValue(TokenStream &tokens, EnumDefinition &current_enum, int &curent_index)
 {
-	std::string identifier = tokens[i].value;
-	i++;
-	if (tokens[i] == "=")
+	std::string identifier = tokens.next().str();
+	if (tokens.accept("="))
 	{
-		i++;
 		// validate that the next token is a number
-		if (!isInt(tokens[i].value))
+		if (!isInt(tokens.peek().value))
 		{
-			reportError("Expected number after '='", tokens[i]);
+			reportError("Expected number after '='", tokens.peek());
 			return false;
 		}
-		curent_index = std::stoi(tokens[i].value);
-		i++;
-		if (tokens[i] == ",")
-		{
-			i++;
-		}
-		else
+		curent_index = std::stoi(tokens.next().str());
+		if (!tokens.accept(","))
 		{
-			reportError("Expected ',' after enum value for identifier " + identifier, tokens[i]);
+			reportError("Expected ',' after enum value for identifier " + identifier, tokens.peek());
 			return false;
 		}
 	}
-	else if (tokens[i] == ",")
+	else if (tokens.accept(","))
 	{
-		i++;
 	}
-	else if (tokens[i] == "}")
+	else if (tokens.peek() == "}")
 	{
 		current_enum.add_value(identifier, curent_index);
 		curent_index++;
@@ -802,7 +808,7 @@ bool ProgramStructure::readEnumValue(std::vector<Token> tokens, int &i, EnumDefi
 	}
 	else
 	{
-		reportError("Expected ',' or '=' after enum value identifier " + identifier, tokens[i]);
+		reportError("Expected ',' or '=' after enum value identifier " + identifier, tokens.peek());
 		return false;
 	}
 
@@ -811,82 +817,70 @@ bool ProgramStructure::readEnumValue(std::vector<Token> tokens, int &i, EnumDefi
 	return true;
 }
 
-bool ProgramStructure::readEnum(std::vector<Token> tokens, int &i, EnumDefinition &current_enum)
+bool ProgramStructure::readEnum(TokenStream &tokens, EnumDefinition &current_enum)
 {
-	if (tokens[i] != "enum")
+	if (!tokens.accept("enum"))
 	{
-		reportError("Expected 'enum' keyword", tokens[i]);
+		reportError("Expected 'enum' keyword", tokens.peek());
 		return false;
 	}
-	i++;
-	current_enum.identifier = tokens[i].value;
-	i++;
-	if (tokens[i] == ":")
+	current_enum.identifier = tokens.next().value;
+	if (tokens.accept(":"))
 	{
-		i++;
-		if (tokens[i] == "gens_enabled")
+		if (tokens.accept("gens_enabled"))
 		{
-			i++;
-			if (tokens[i] != "(")
+			if (!tokens.accept("("))
 			{
-				reportError("Expected '(' after gens_enabled", tokens[i]);
+				reportError("Expected '(' after gens_enabled", tokens.peek());
 				return false;
 			}
 			do
 			{
-				i++;
-				current_enum.enabled_for_generators.insert(tokens[i]);
-				i++;
-			} while (tokens[i] == ",");
-			if (tokens[i] != ")")
+				current_enum.enabled_for_generators.insert(tokens.next());
+			} while (tokens.accept(","));
+			if (!tokens.accept(")"))
 			{
-				reportError("Expected ')' after gens_enabled", tokens[i]);
+				reportError("Expected ')' after gens_enabled", tokens.peek());
 				return false;
 			}
-			i++;
 		}
-		else if (tokens[i] == "gens_disabled")
+		else if (tokens.accept("gens_disabled"))
 		{
-			i++;
-			if (tokens[i] != "(")
+			if (!tokens.accept("("))
 			{
-				reportError("Expected '(' after gens_disabled", tokens[i]);
+				reportError("Expected '(' after gens_disabled", tokens.peek());
 				return false;
 			}
 			do
 			{
-				i++;
-				current_enum.disabled_for_generators.insert(tokens[i]);
-				i++;
-			} while (tokens[i] == ",");
-			if (tokens[i] != ")")
+				current_enum.disabled_for_generators.insert(tokens.next());
+			} while (tokens.accept(","));
+			if (!tokens.accept(")"))
 			{
-				reportError("Expected ')' after gens_disabled", tokens[i]);
+				reportError("Expected ')' after gens_disabled", tokens.peek());
 				return false;
 			}
-			i++;
 		}
 		else
 		{
-			reportError("Invalid enum modifier", tokens[i]);
+			reportError("Invalid enum modifier", tokens.peek());
 			return false;
 		}
 	}
-	if (tokens[i] != "{")
+	if (!tokens.accept("{"))
 	{
-		if (tokens[i] == "gens_enabled" || tokens[i] == "gens_disabled")
+		if (tokens.peek() == "gens_enabled" || tokens.peek() == "gens_disabled")
 		{
-			reportError("Cant have a whitelist and blacklist on the same struct", tokens[i]);
+			reportError("Cant have a whitelist and blacklist on the same struct", tokens.peek());
 			return false;
 		}
-		reportError("Expected '{' after enum identifier", tokens[i]);
+		reportError("Expected '{' after enum identifier", tokens.peek());
 		return false;
 	}
-	i++;
 	int curent_index = 0;
-	while (tokens[i] != "}")
+	while (!tokens.accept("}"))
 	{
-		if (!readEnumValue(tokens, i, current_enum, curent_index))
+		if (!readEnumValue(tokens, current_enum, curent_index))
 		{
 			return false;
 		}
@@ -894,34 +888,151 @@ bool ProgramStructure::readEnum(std::vector<Token> tokens, int &i, EnumDefinitio
 	return true;
 }
 
-bool ProgramStructure::readConfig(std::vector<Token> tokens, int &i)
+bool ProgramStructure::readConfig(TokenStream &tokens)
 {
 	// This function is a placeholder for future configuration parsing
-	// Currently, it does nothing and just returns true
-	if (tokens[i] != "config")
+	// Currently, it skips the config block and just returns true
+	if (!tokens.accept("config"))
 	{
-		reportError("Expected 'config' keyword", tokens[i]);
+		reportError("Expected 'config' keyword", tokens.peek());
 		return false;
 	}
-	i++;
-	if (tokens[i] != "{")
+	if (!tokens.accept("{"))
 	{
-		reportError("Expected '{' after config keyword", tokens[i]);
+		reportError("Expected '{' after config keyword", tokens.peek());
 		return false;
 	}
-	i++;
-	while (tokens[i] != "}")
+	while (!tokens.accept("}"))
 	{
-		i++;
+		if (tokens.atEnd())
+		{
+			reportError("Expected '}' to close config block", tokens.peek());
+			return false;
+		}
+		tokens.advance();
 	}
-	i++;
 	return true;
 }
 
+// Tarjan's algorithm over the struct dependency graph, returns every strongly
+// connected component that forms a cycle, in the order they are completed
+static std::vector<std::vector<size_t>> findCycles(const std::vector<std::vector<size_t>> &edges)
+{
+	const size_t unvisited = SIZE_MAX;
+	std::vector<size_t> order(edges.size(), unvisited);
+	std::vector<size_t> low(edges.size(), 0);
+	std::vector<bool> on_stack(edges.size(), false);
+	std::vector<size_t> stack;
+	std::vector<std::vector<size_t>> cycles;
+	size_t counter = 0;
+
+	// explicit call stack of (node, next edge), deep models must not overflow
+	std::vector<std::pair<size_t, size_t>> call_stack;
+	for (size_t root = 0; root < edges.size(); root++)
+	{
+		if (order[root] != unvisited)
+		{
+			continue;
+		}
+		call_stack.push_back({root, 0});
+		while (!call_stack.empty())
+		{
+			auto &[node, next_edge] = call_stack.back();
+			if (next_edge == 0)
+			{
+				order[node] = low[node] = counter++;
+				stack.push_back(node);
+				on_stack[node] = true;
+			}
+			if (next_edge < edges[node].size())
+			{
+				size_t target = edges[node][next_edge++];
+				if (order[target] == unvisited)
+				{
+					call_stack.push_back({target, 0});
+				}
+				else if (on_stack[target])
+				{
+					low[node] = std::min(low[node], order[target]);
+				}
+				continue;
+			}
+
+			size_t finished = node;
+			call_stack.pop_back();
+			if (!call_stack.empty())
+			{
+				size_t parent = call_stack.back().first;
+				low[parent] = std::min(low[parent], low[finished]);
+			}
+			if (low[finished] != order[finished])
+			{
+				continue;
+			}
+			std::vector<size_t> component;
+			size_t member;
+			do
+			{
+				member = stack.back();
+				stack.pop_back();
+				on_stack[member] = false;
+				component.push_back(member);
+			} while (member != finished);
+			bool self_loop = std::find(edges[finished].begin(), edges[finished].end(), finished) != edges[finished].end();
+			if (component.size() > 1 || self_loop)
+			{
+				cycles.push_back(std::move(component));
+			}
+		}
+	}
+	return cycles;
+}
+
+// shortest path from start back to itself inside one strongly connected component
+static std::vector<size_t> cyclePath(const std::vector<std::vector<size_t>> &edges, const std::vector<size_t> &component, size_t start)
+{
+	std::unordered_map<size_t, size_t> parent;
+	std::unordered_set<size_t> members(component.begin(), component.end());
+	std::deque<size_t> queue = {start};
+	while (!queue.empty())
+	{
+		size_t node = queue.front();
+		queue.pop_front();
+		for (size_t target : edges[node])
+		{
+			if (members.count(target) == 0)
+			{
+				continue;
+			}
+			if (target == start)
+			{
+				std::vector<size_t> path = {start};
+				for (size_t n = node; n != start; n = parent[n])
+				{
+					path.push_back(n);
+				}
+				std::reverse(path.begin() + 1, path.end());
+				path.push_back(start);
+				return path;
+			}
+			if (parent.emplace(target, node).second)
+			{
+				queue.push_back(target);
+			}
+		}
+	}
+	return {start, start};
+}
+
 bool ProgramStructure::validate()
 {
-	for (auto &s : structs)
+	// struct dependency graph, an edge for every member that embeds another
+	// struct by value. Members with a reference break the dependency.
+	std::vector<std::vector<size_t>> edges(structs.size());
+
+	for (size_t i = 0; i < structs.size(); i++)
 	{
+		auto &s = structs[i];
 		for (auto &[generator, mv] : s.getMemberVariables())
 		{
 			if (mv.type.identifier() == s.getIdentifier())
@@ -934,117 +1045,107 @@ bool ProgramStructure::validate()
 							s.getIdentifier() + "{\n"
 												"\t\t" +
 							mv.type.identifier() + ": " + mv.identifier + ": reference;\n"
-																		  "\t}");
+																		  "\t}",
+							mv.position);
 				return false;
 			}
 
-			if (tokenIsStruct(mv.type.identifier()))
+			bool mv_has_ref = !(mv.reference.struct_name.empty() && mv.reference.variable_name.empty());
+			StructDefinition *member_struct = getTypeStruct(mv.type);
+			if (member_struct != nullptr && !mv_has_ref)
 			{
-				StructDefinition &struct_def = getStruct(mv.type.identifier());
-				for (auto &[generator, other_mv] : struct_def.getMemberVariables())
-				{
-					if (other_mv.type.identifier() == s.getIdentifier())
-					{
-						bool mv_has_ref = !(mv.reference.struct_name.empty() && mv.reference.variable_name.empty());
-						bool other_mv_has_ref = !(other_mv.reference.struct_name.empty() && other_mv.reference.variable_name.empty());
-						if (mv_has_ref && other_mv_has_ref)
-						{
-							reportError("Circular dependancy detected. use the 'reference' modifyer to resolve. Resolution examples:\n"
-										"\tstruct " +
-										s.getIdentifier() + "{\n"
-															"\t\t" +
-										mv.type.identifier() + ": " + mv.identifier + ": reference;\n"
-																					  "\t}\n"
-																					  "\n"
-																					  "\tstruct " +
-										struct_def.getIdentifier() + "{\n"
-																	 "\t\t" +
-										other_mv.type.identifier() + ": " + other_mv.identifier + ";\n"
-																								  "\t}\n"
-																								  "\n"
-																								  "or\n"
-																								  "\n"
-																								  "\tstruct " +
-										s.getIdentifier() + "{\n"
-															"\t\t" +
-										mv.type.identifier() + ": " + mv.identifier + ": reference;\n"
-																					  "\t}\n"
-																					  "\n"
-																					  "\tstruct " +
-										struct_def.getIdentifier() + "{\n"
-																	 "\t\t" +
-										other_mv.type.identifier() + ": " + other_mv.identifier + ": reference;\n"
-																								  "\t}");
-							return false;
-						}
-					}
-				}
+				edges[i].push_back(member_struct - structs.data());
 			}
 			if (mv.type.is_array() && mv.type.element_type().identifier().empty())
 			{
-				reportError("Expected array element type for " + mv.identifier);
+				reportError("Expected array element type for " + mv.identifier, mv.position);
 				return false;
 			}
 			if (!mv.reference.struct_name.empty())
 			{
-				if (!tokenIsStruct(mv.reference.struct_name))
+				auto target = struct_indices.find(mv.reference.struct_name);
+				if (target == struct_indices.end())
 				{
-					reportError("Expected struct name for reference of " + mv.identifier);
+					reportError("Expected struct name for reference of " + mv.identifier, mv.position);
 					return false;
 				}
 				if (mv.reference.variable_name.empty())
 				{
-					reportError("Expected member variable name for reference of " + mv.identifier);
+					reportError("Expected member variable name for reference of " + mv.identifier, mv.position);
 					return false;
 				}
 				// if struct does not have member variable with name of reference variable name
-				if (!getStruct(mv.reference.struct_name).has_member_variable(mv.reference.variable_name))
+				if (!structs[target->second].has_member_variable(mv.reference.variable_name))
 				{
-					reportError("Struct " + mv.reference.struct_name + " does not have member variable " + mv.reference.variable_name);
+					reportError("Struct " + mv.reference.struct_name + " does not have member variable " + mv.reference.variable_name, mv.position);
 					return false;
 				}
 			}
 		}
 	}
-	return true;
-}
 
-bool ProgramStructure::tokenIsType(std::string token)
-{
-	if (token == "int8" || token == "int16" || token == "int32" || token == "int64" || token == "uint8" || token == "uint16" || token == "uint32" || token == "uint64" || token == "float" || token == "double" || token == "bool" || token == "string" || token == "char" || token == "array")
+	std::vector<std::vector<size_t>> cycles = findCycles(edges);
+	if (cycles.empty())
 	{
 		return true;
 	}
-	return false;
-}
+	// report the cycle through the first struct that was defined, so the
+	// message does not depend on the order the graph was walked in
+	auto first = std::min_element(cycles.begin(), cycles.end(), [](const std::vector<size_t> &a, const std::vector<size_t> &b)
+								  { return *std::min_element(a.begin(), a.end()) < *std::min_element(b.begin(), b.end()); });
+	std::vector<size_t> path = cyclePath(edges, *first, *std::min_element(first->begin(), first->end()));
 
-bool ProgramStructure::tokenIsStruct(std::string token)
-{
-	for (auto &s : structs)
+	std::string chain;
+	std::string examples;
+	// the error points at the member that should get the 'reference'
+	SourcePosition position = structs[path.front()].position;
+	for (size_t i = 0; i + 1 < path.size(); i++)
 	{
-		if (s.getIdentifier() == token)
+		StructDefinition &from = structs[path[i]];
+		chain += from.getIdentifier() + " -> ";
+		for (auto &[generator, mv] : from.getMemberVariables())
 		{
-			return true;
+			if (getTypeStruct(mv.type) == &structs[path[i + 1]] && mv.reference.struct_name.empty() && mv.reference.variable_name.empty())
+			{
+				examples += "\tstruct " + from.getIdentifier() + "{\n"
+							"\t\t" + mv.type.identifier() + ": " + mv.identifier + (i == 0 ? ": reference;\n" : ";\n") +
+							"\t}\n";
+				if (i == 0)
+				{
+					position = mv.position;
+				}
+				break;
+			}
 		}
 	}
+	chain += structs[path.back()].getIdentifier();
+	examples.pop_back();
+	reportError("Circular dependancy detected: " + chain + "\n"
+				"use the 'reference' modifyer on at least one member of the cycle to resolve. Resolution example:\n" + examples,
+				position);
 	return false;
 }
 
-bool ProgramStructure::tokenIsEnum(std::string token)
+bool ProgramStructure::tokenIsType(std::string_view token)
 {
-	for (auto &e : enums)
-	{
-		if (e.identifier == token)
-		{
-			return true;
-		}
-	}
-	return false;
+	static const std::unordered_set<std::string_view> base_types = {INT8, INT16, INT32, INT64, UINT8, UINT16, UINT32, UINT64, FLOAT, DOUBLE, BOOL, STRING, CHAR, ARRAY};
+	return base_types.count(token) != 0;
+}
+
+bool ProgramStructure::tokenIsStruct(std::string_view token)
+{
+	return struct_indices.find(token) != struct_indices.end();
+}
+
+bool ProgramStructure::tokenIsEnum(std::string_view token)
+{
+	return enum_indices.find(token) != enum_indices.end();
 }
 
-bool ProgramStructure::tokenIsValidTypeName(std::string token)
+bool ProgramStructure::tokenIsValidTypeName(std::string_view token)
 {
-	if (tokenIsType(token) || tokenIsStruct(token) || tokenIsEnum(token) || std::find(type_names.begin(), type_names.end(), token) != type_names.end())
+	if (tokenIsType(token) || tokenIsStruct(token) || tokenIsEnum(token) || type_names.count(token) != 0 ||
+		(known_type_names != nullptr && known_type_names->count(token) != 0))
 	{
 		return true;
 	}
@@ -1053,38 +1154,96 @@ bool ProgramStructure::tokenIsValidTypeName(std::string token)
 
 StructDefinition &ProgramStructure::getStruct(std::string identifier)
 {
-	for (auto &s : structs)
+	auto it = struct_indices.find(identifier);
+	if (it != struct_indices.end())
 	{
-		if (s.getIdentifier() == identifier)
-		{
-			return s;
-		}
+		return structs[it->second];
 	}
 	throw std::runtime_error("Struct not found: " + identifier);
 }
 
 EnumDefinition &ProgramStructure::getEnum(std::string identifier)
 {
-	for (auto &e : enums)
+	auto it = enum_indices.find(identifier);
+	if (it != enum_indices.end())
 	{
-		if (e.identifier == identifier)
-		{
-			return e;
-		}
+		return enums[it->second];
 	}
 	throw std::runtime_error("Enum not found: " + identifier);
 }
 
-bool ProgramStructure::parseTypeNames(std::vector<Token> tokens)
+StructDefinition &ProgramStructure::addStruct(StructDefinition s)
+{
+	auto it = struct_indices.find(s.getIdentifier());
+	if (it != struct_indices.end())
+	{
+		structs[it->second].update(s);
+		return structs[it->second];
+	}
+	struct_indices.emplace(interner->intern(s.getIdentifier()), structs.size());
+	resolveType(s.getIdentifier(), TypeKind::Struct, structs.size());
+	structs.push_back(std::move(s));
+	return structs.back();
+}
+
+EnumDefinition &ProgramStructure::addEnum(EnumDefinition e)
+{
+	auto it = enum_indices.find(e.identifier);
+	if (it != enum_indices.end())
+	{
+		enums[it->second].update(e);
+		return enums[it->second];
+	}
+	enum_indices.emplace(interner->intern(e.identifier), enums.size());
+	resolveType(e.identifier, TypeKind::Enum, enums.size());
+	enums.push_back(std::move(e));
+	return enums.back();
+}
+
+void ProgramStructure::resolveType(std::string_view name, TypeKind kind, size_t index)
+{
+	const TypeEntry *entry = TypeDefinition(name).getEntry();
+	if (entry->kind != TypeKind::Other)
+	{
+		return; // base type names can not be redefined
+	}
+	if (entry->id >= type_resolutions.size())
+	{
+		type_resolutions.resize(entry->id + 1);
+	}
+	type_resolutions[entry->id] = TypeResolution{kind, index};
+}
+
+StructDefinition *ProgramStructure::getTypeStruct(const TypeDefinition &type)
+{
+	const TypeEntry *entry = type.getEntry();
+	if (entry->id >= type_resolutions.size() || type_resolutions[entry->id].kind != TypeKind::Struct)
+	{
+		return nullptr;
+	}
+	return &structs[type_resolutions[entry->id].index];
+}
+
+EnumDefinition *ProgramStructure::getTypeEnum(const TypeDefinition &type)
 {
-	for (int i = 0; i < tokens.size(); i++)
+	const TypeEntry *entry = type.getEntry();
+	if (entry->id >= type_resolutions.size() || type_resolutions[entry->id].kind != TypeKind::Enum)
+	{
+		return nullptr;
+	}
+	return &enums[type_resolutions[entry->id].index];
+}
+
+bool ProgramStructure::parseTypeNames(const std::vector<Token> &tokens)
+{
+	for (size_t i = 0; i < tokens.size(); i++)
 	{
 		if (tokens[i] == "struct" || tokens[i] == "enum")
 		{
 			i++;
 			if (i < tokens.size())
 			{
-				type_names.push_back(tokens[i].value);
+				type_names.insert(interner->intern(tokens[i].value));
 			}
 			else
 			{
@@ -1097,87 +1256,161 @@ bool ProgramStructure::parseTypeNames(std::vector<Token> tokens)
 	return true;
 }
 
+static void recordInclude(FileParse *parse, const std::string &path, bool absolute, const Token &token)
+{
+	parse->items.push_back({FileParse::INCLUDE, parse->includes.size()});
+	parse->includes.push_back({path, absolute, token});
+}
+
+StructDefinition &ProgramStructure::defineStruct(StructDefinition s)
+{
+	if (recording != nullptr)
+	{
+		recording->items.push_back({FileParse::STRUCT, recording->structs.size()});
+		recording->structs.push_back(s);
+	}
+	return addStruct(std::move(s));
+}
+
+EnumDefinition &ProgramStructure::defineEnum(EnumDefinition e)
+{
+	if (recording != nullptr)
+	{
+		recording->items.push_back({FileParse::ENUM, recording->enums.size()});
+		recording->enums.push_back(e);
+	}
+	return addEnum(std::move(e));
+}
+
 bool ProgramStructure::readFile(std::string file_path)
 {
-	if (std::find(already_included_files.begin(), already_included_files.end(), file_path) != already_included_files.end())
+	return loadFile(file_path) && validate();
+}
+
+bool ProgramStructure::loadFile(const std::string &file_path)
+{
+	if (!included_file_set.insert(file_path).second)
 	{
 		return true;
 	}
 	already_included_files.push_back(file_path);
 
-	std::fstream file;
-	file.open(file_path, std::ios::in);
-	if (!file.is_open())
+	SourceBuffer *source = lexFile(file_path);
+	if (source == nullptr)
 	{
-		current_position.file_path = file_path;
-		reportError("Failed to open file " + file_path);
 		return false;
 	}
+	return readDefinitions(source->tokens, file_path);
+}
+
+SourceBuffer *ProgramStructure::lexFile(const std::string &file_path)
+{
+	SourceBuffer *source = openFile(file_path);
+	if (source == nullptr || !lexSource(source, file_path))
+	{
+		return nullptr;
+	}
+	return source;
+}
+
+SourceBuffer *ProgramStructure::openFile(const std::string &file_path)
+{
+	SourceBuffer *source = nullptr;
+	if (unsaved_files && unsaved_files->count(file_path) != 0)
+	{
+		source = source_manager->open(file_path, unsaved_files->at(file_path));
+	}
+	else
+	{
+		source = source_manager->open(file_path);
+	}
+	if (source == nullptr)
+	{
+		current_position.file_id = FileTable::instance().intern(file_path);
+		reportError("Failed to open file " + file_path);
+		return nullptr;
+	}
 
 	// Set current file context
 	current_file = file_path;
 	current_position = SourcePosition(file_path, 1, 1);
+	return source;
+}
 
-	std::string whole_file;
-	file.seekg(0, std::ios::end);
-	whole_file.reserve(file.tellg());
-	file.seekg(0, std::ios::beg);
-	whole_file.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-	file.close();
-
-	std::vector<Token> tokens = tokenizeWithPosition(whole_file, file_path);
-	if (!parseTypeNames(tokens))
+bool ProgramStructure::lexSource(SourceBuffer *source, const std::string &file_path)
+{
+	source->tokens = tokenizeWithPosition(source->file.text(), file_path);
+	if (!parseTypeNames(source->tokens))
 	{
 		reportError("Failed to parse type and enum names from file " + file_path);
 		return false;
 	}
+	return true;
+}
 
+// path of an included file as seen from the including file
+static std::string resolve_include_path(const std::string &file_path, std::string include_file)
+{
+	// check if this is absolute path or relative path
+	if (include_file[0] == '/')
+	{
+		return include_file;
+	}
+	// get the path of the current file
+	std::string current_file_path = std::filesystem::path(file_path).parent_path().string();
+	// if the include_file starts with './'
+	if (include_file.substr(0, 2) == "./")
+	{
+		include_file = include_file.substr(2);
+	}
+	current_file_path += "/" + include_file;
+	return current_file_path;
+}
+
+bool ProgramStructure::readDefinitions(const std::vector<Token> &tokens, const std::string &file_path)
+{
 	StructDefinition current_struct;
 	EnumDefinition current_enum;
-	MemberVariableDefinition current_MemberVariableDefinition;
-	for (int i = 0; i < tokens.size(); i++)
+	TokenStream stream(tokens);
+	while (!stream.atEnd())
 	{
 		// Update current parsing position
-		current_position = tokens[i].position;
+		current_position = stream.peek().position;
 
-		std::string token = tokens[i].value;
+		std::string_view token = stream.peek().value;
 		if (token == "include")
 		{
-			i++;
-			std::string include_file = tokens[i].value;
-			// check if this is absolute path or relative path
-			if (include_file[0] == '/')
+			stream.advance();
+			const Token &include_token = stream.next();
+			std::string include_file = include_token.str();
+			bool absolute = include_file[0] == '/';
+			std::string include_path = resolve_include_path(file_path, include_file);
+			if (recording != nullptr)
 			{
-				readFile(include_file);
+				recordInclude(recording, include_path, absolute, include_token);
 			}
-			else
+			else if (absolute)
 			{
-				// get the path of the current file
-				std::string current_file_path = std::filesystem::path(file_path).parent_path().string();
-				// if the include_file starts with './'
-				if (include_file.substr(0, 2) == "./")
-				{
-					include_file = include_file.substr(2);
-				}
-				current_file_path += "/" + include_file;
-				if (!readFile(current_file_path))
-				{
-					reportError("Failed to read included file " + current_file_path, tokens[i]);
-					return false;
-				}
+				loadFile(include_path);
+			}
+			else if (!loadFile(include_path))
+			{
+				reportError("Failed to read included file " + include_path, include_token);
+				return false;
 			}
 		}
-
-		if (token == "declare"){
-			i++;
+		else if (token == "declare")
+		{
+			stream.advance();
 			//if struct or enum
-			if (tokens[i] == "struct")
+			if (stream.accept("struct"))
 			{
-				i++;
 				// Handle forward declaration of struct
 				StructDefinition forward_decl;
-				forward_decl.setIdentifier(tokens[i].value);
+				forward_decl.position = stream.peek().position;
+				forward_decl.setIdentifier(stream.next().str());
 				MemberVariableDefinition id_member;
+				id_member.position = forward_decl.position;
 				id_member.type = TypeDefinition("int64");
 				id_member.identifier = "id";
 				id_member.primary_key = true;
@@ -1185,87 +1418,427 @@ bool ProgramStructure::readFile(std::string file_path)
 				id_member.required = true;
 				id_member.unique = true;
 				id_member.description = "Primary unique identifier for " + current_struct.getIdentifier();
-				forward_decl.add_member_variable(id_member);
-				structs.push_back(forward_decl);
-				i ++; // Skip the struct name token
+				forward_decl.add_member_variable(std::move(id_member));
+				defineStruct(std::move(forward_decl));
 			}
-			else if (tokens[i] == "enum")
+			else if (stream.accept("enum"))
 			{
-				i++;
 				// Handle forward declaration of enum
 				EnumDefinition forward_decl;
-				forward_decl.identifier = tokens[i].value;
-				enums.push_back(forward_decl);
-				i ++; // Skip the enum name token
+				forward_decl.identifier = stream.next().value;
+				defineEnum(std::move(forward_decl));
 			}
 			else{
-				reportError("Expected 'struct' or 'enum' after 'declare'", tokens[i]);
+				reportError("Expected 'struct' or 'enum' after 'declare'", stream.peek());
 				return false;
 			}
-			if(tokens[i] != ";"){
-				reportError("Expected ';' after forward declaration", tokens[i]);
+			if(!stream.accept(";")){
+				reportError("Expected ';' after forward declaration", stream.peek());
 				return false;
 			}
 		}
-
-		if (token == "struct")
+		else if (token == "struct")
 		{
-			if (readStruct(tokens, i, current_struct))
+			if (readStruct(stream, current_struct))
 			{
-				auto it = std::find_if(structs.begin(), structs.end(), [&](const StructDefinition& s) { return s.getIdentifier() == current_struct.getIdentifier(); });
-				if (it != structs.end())
+				// clear() keeps the gens_enabled / gens_disabled sets for the next struct
+				std::set<std::string> gens_enabled = current_struct.getGensEnabled();
+				std::set<std::string> gens_disabled = current_struct.getGensDisabled();
+				defineStruct(std::move(current_struct));
+				current_struct.clear();
+				for (const auto &gen : gens_enabled)
 				{
-					it->update(current_struct);
-				}else{
-					structs.push_back(current_struct);
+					current_struct.add_gen_enabled(gen);
+				}
+				for (const auto &gen : gens_disabled)
+				{
+					current_struct.add_gen_disabled(gen);
 				}
-				current_struct.clear();
 			}
 			else
 			{
-				reportError("Failed to read struct", tokens[i]);
+				reportError("Failed to read struct", stream.peek());
 				return false;
 			}
 		}
-		if (token == "enum")
+		else if (token == "enum")
 		{
-			if (readEnum(tokens, i, current_enum))
+			if (readEnum(stream, current_enum))
 			{
 				int count = current_enum.values.size();
 				current_enum.add_value("Unknown", -1);
 				current_enum.add_value("Count", count);
-				auto it = std::find_if(enums.begin(),enums.end(),[&](const EnumDefinition& e){return e.identifier==current_enum.identifier;});
-				if (it != enums.end())
-				{
-					it->update(current_enum);
-				}
-				else
-				{
-					enums.push_back(current_enum);
-				}
+				defineEnum(current_enum);
 				current_enum.clear();
 			}
 			else
 			{
-				reportError("Failed to read enum", tokens[i]);
+				reportError("Failed to read enum", stream.peek());
 				return false;
 			}
 		}
-		if (token == "config")
+		else if (token == "config")
 		{
-			if (!readConfig(tokens, i))
+			if (!readConfig(stream))
 			{
-				reportError("Failed to read config", tokens[i]);
+				reportError("Failed to read config", stream.peek());
 				return false;
 			}
 		}
+		else
+		{
+			stream.advance();
+		}
+	}
+	return true;
+}
+
+// state of one input file while readFiles works on it
+struct ParallelFile
+{
+	std::string path;
+	ProgramStructure model;
+	FileParse parse;
+	std::string lex_diagnostics;
+	std::string diagnostics;
+	SourceBuffer *source = nullptr;
+	bool lexed = false;
+	bool cached = false;
+	bool parsed = false;
+};
+
+// Bump whenever the parser or SchemaCodec changes what a FileParse holds or
+// how it is encoded, so the parse cache misses rather than loading old entries.
+static const char parser_version[] = "schemalang-parser 1";
+
+const char *ProgramStructure::parserVersion()
+{
+	return parser_version;
+}
+
+// lexes a file for readFiles and collects what the other files need from it
+static void lex_parallel_file(ParallelFile &file)
+{
+	file.lexed = file.model.lexSource(file.source, file.path);
+	if (!file.lexed)
+	{
+		return;
+	}
+	file.parse.type_names.assign(file.model.type_names.begin(), file.model.type_names.end());
+	const std::vector<Token> &tokens = file.source->tokens;
+	for (size_t t = 0; t + 1 < tokens.size(); t++)
+	{
+		if (tokens[t] == "include")
+		{
+			file.parse.include_candidates.push_back(resolve_include_path(file.path, tokens[t + 1].str()));
+		}
+		else if (tokens[t] == "struct")
+		{
+			file.parse.struct_names.push_back(tokens[t + 1].str());
+		}
+	}
+}
+
+bool ProgramStructure::readFiles(const std::vector<std::string> &file_paths, unsigned jobs, const std::function<void(const std::string &, bool)> &on_file_read)
+{
+	ParseCache *cache = parse_cache.get();
+
+	// Lex every input in parallel, or load its parse from the cache. Includes
+	// are not known before parsing, so every "include <path>" token pair is
+	// treated as a candidate; lexing a file that turns out not to be included
+	// is harmless because only real includes are merged.
+	std::deque<ParallelFile> files;
+	std::unordered_map<std::string, size_t> file_indices;
+	auto schedule = [&](const std::string &path)
+	{
+		if (file_indices.count(path) != 0 || included_file_set.count(path) != 0)
+		{
+			return;
+		}
+		file_indices.emplace(path, files.size());
+		files.emplace_back().path = path;
+	};
+	for (const auto &path : file_paths)
+	{
+		schedule(path);
+	}
+
+	size_t wave_begin = 0;
+	while (wave_begin < files.size())
+	{
+		size_t wave_end = files.size();
+		parallelFor(wave_end - wave_begin, jobs, [&](size_t i)
+		{
+			ParallelFile &file = files[wave_begin + i];
+			file.model.diagnostics = &file.diagnostics;
+			file.model.unsaved_files = unsaved_files;
+			file.source = file.model.openFile(file.path);
+			if (file.source == nullptr)
+			{
+				return;
+			}
+			if (cache && cache->load(file.path, file.source->file.text(), file.parse))
+			{
+				file.cached = true;
+				file.parsed = true;
+				return;
+			}
+			lex_parallel_file(file);
+		});
+		for (size_t i = wave_begin; i < wave_end; i++)
+		{
+			files[i].lex_diagnostics.swap(files[i].diagnostics);
+			for (const auto &path : files[i].parse.include_candidates)
+			{
+				schedule(path);
+			}
+		}
+		wave_begin = wave_end;
+	}
+
+	// Every file may use any struct or enum name of the whole input set, and
+	// anything that was read before this call.
+	std::unordered_set<std::string_view> all_type_names(type_names.begin(), type_names.end());
+	std::unordered_set<std::string_view> all_struct_names;
+	for (const auto &[name, index] : struct_indices)
+	{
+		all_type_names.insert(name);
+		all_struct_names.insert(name);
+	}
+	for (const auto &[name, index] : enum_indices)
+	{
+		all_type_names.insert(name);
 	}
-	return validate();
+	for (auto &file : files)
+	{
+		all_type_names.insert(file.parse.type_names.begin(), file.parse.type_names.end());
+		all_struct_names.insert(file.parse.struct_names.begin(), file.parse.struct_names.end());
+	}
+
+	// Parse every file on its own, recording its statements
+	parallelFor(files.size(), jobs, [&](size_t i)
+	{
+		ParallelFile &file = files[i];
+		if (file.cached)
+		{
+			// a cached parse only holds while every type it uses still exists
+			bool types_known = true;
+			for (auto &s : file.parse.structs)
+			{
+				for (auto &[generator, mv] : s.getMemberVariables())
+				{
+					for (const std::string &type : {mv.type.identifier(), mv.type.element_type().identifier()})
+					{
+						if (!type.empty() && !tokenIsType(type) && all_type_names.count(type) == 0)
+						{
+							types_known = false;
+						}
+					}
+				}
+			}
+			if (types_known)
+			{
+				return;
+			}
+			file.cached = false;
+			file.parsed = false;
+			file.parse = FileParse();
+			lex_parallel_file(file);
+		}
+		if (!file.lexed)
+		{
+			return;
+		}
+		file.model.recording = &file.parse;
+		file.model.known_type_names = &all_type_names;
+		file.model.known_struct_names = &all_struct_names;
+		file.parsed = file.model.readDefinitions(file.source->tokens, file.path);
+		// diagnostics are not cached, so only clean parses are
+		if (cache && file.parsed && file.lex_diagnostics.empty() && file.diagnostics.empty())
+		{
+			cache->store(file.path, file.source->file.text(), file.parse);
+		}
+	});
+
+	// Merge single threaded in the order readFile would have visited the
+	// files, so struct order and update() merges do not depend on timing.
+	// A failing file is still merged to the end, so the diagnostics of every
+	// file are printed in order before readFiles fails.
+	std::function<bool(ParallelFile &)> merge = [&](ParallelFile &file) -> bool
+	{
+		bool ok = file.parsed;
+		already_included_files.push_back(file.path);
+		included_file_set.insert(file.path);
+		file.model.diagnostics = nullptr;
+		printDiagnostic("%s", file.lex_diagnostics.c_str());
+		for (const auto &item : file.parse.items)
+		{
+			if (item.kind == FileParse::STRUCT)
+			{
+				// every file is merged once, so its definitions can be moved out
+				addStruct(std::move(file.parse.structs[item.index]));
+			}
+			else if (item.kind == FileParse::ENUM)
+			{
+				addEnum(std::move(file.parse.enums[item.index]));
+			}
+			else
+			{
+				const FileParse::Include &include = file.parse.includes[item.index];
+				if (included_file_set.count(include.path) != 0)
+				{
+					continue;
+				}
+				auto it = file_indices.find(include.path);
+				// a path the candidate scan could not see is read the sequential way
+				bool included = it != file_indices.end() ? merge(files[it->second]) : loadFile(include.path);
+				if (!included && !include.absolute)
+				{
+					// a cached file was never lexed, its tokens are only needed for this context
+					if (file.cached && file.source->tokens.empty())
+					{
+						file.source->tokens = file.model.tokenizeWithPosition(file.source->file.text(), file.path);
+					}
+					file.model.reportError("Failed to read included file " + include.path, include.token);
+					ok = false;
+				}
+			}
+		}
+		printDiagnostic("%s", file.diagnostics.c_str());
+		reported_errors.insert(reported_errors.end(), file.model.reported_errors.begin(), file.model.reported_errors.end());
+		return ok;
+	};
+
+	bool all_ok = true;
+	for (const auto &path : file_paths)
+	{
+		if (included_file_set.count(path) != 0)
+		{
+			if (on_file_read)
+			{
+				on_file_read(path, true);
+			}
+			continue;
+		}
+		bool ok = merge(files[file_indices.at(path)]);
+		if (on_file_read)
+		{
+			on_file_read(path, ok);
+		}
+		all_ok = all_ok && ok;
+	}
+	bool valid = validate();
+	return all_ok && valid;
+}
+
+static const char compiled_magic[4] = {'S', 'L', 'C', 'S'};
+static const uint32_t compiled_format = 2;
+
+// image layout: magic, format, body size, body hash, then the body holding
+// the source file list, the structs with their source positions and the
+// enums. Everything is addressed by reading it in order, so the image has no
+// pointers or offsets to fix up.
+bool ProgramStructure::writeCompiled(const std::string &file_path)
+{
+	CacheWriter body;
+	body.strings(already_included_files);
+	body.u32((uint32_t)structs.size());
+	for (const auto &s : structs)
+	{
+		if (!write_struct(body, s))
+		{
+			reportError("Struct " + s.getIdentifier() + " holds generator content and can not be compiled", s.position);
+			return false;
+		}
+		write_positions(body, s);
+	}
+	body.u32((uint32_t)enums.size());
+	for (const auto &e : enums)
+	{
+		write_enum(body, e);
+	}
+
+	CacheWriter w;
+	w.out.append(compiled_magic, sizeof(compiled_magic));
+	w.u32(compiled_format);
+	w.u64(body.out.size());
+	w.u64(ParseCache::hash(body.out));
+	w.out += body.out;
+	return writeFileAtomically(file_path, w.out);
+}
+
+bool ProgramStructure::readCompiled(const std::string &file_path)
+{
+	SourceFile image;
+	if (!image.open(file_path))
+	{
+		printDiagnostic("Error: failed to open compiled schema %s\n", file_path.c_str());
+		return false;
+	}
+
+	CacheReader r;
+	r.in = image.text();
+	char magic[4];
+	if (!r.take(magic, sizeof(magic)) || memcmp(magic, compiled_magic, sizeof(magic)) != 0)
+	{
+		printDiagnostic("Error: %s is not a compiled schema\n", file_path.c_str());
+		return false;
+	}
+	uint32_t format = r.u32();
+	if (format != compiled_format)
+	{
+		printDiagnostic("Error: %s has compiled schema format %u, expected %u\n", file_path.c_str(), format, compiled_format);
+		return false;
+	}
+	uint64_t size = r.u64();
+	uint64_t hash = r.u64();
+	if (!r.ok || size != r.in.size() - r.pos || hash != ParseCache::hash(r.in.substr(r.pos)))
+	{
+		printDiagnostic("Error: compiled schema %s is damaged\n", file_path.c_str());
+		return false;
+	}
+
+	std::vector<std::string> sources = read_strings(r);
+	std::vector<StructDefinition> compiled_structs;
+	std::vector<EnumDefinition> compiled_enums;
+	for (uint32_t i = 0, n = r.count(); i < n && r.ok; i++)
+	{
+		read_struct(r, compiled_structs.emplace_back());
+		read_positions(r, compiled_structs.back());
+	}
+	for (uint32_t i = 0, n = r.count(); i < n && r.ok; i++)
+	{
+		read_enum(r, compiled_enums.emplace_back());
+	}
+	if (!r.ok || r.pos != r.in.size())
+	{
+		printDiagnostic("Error: compiled schema %s is damaged\n", file_path.c_str());
+		return false;
+	}
+
+	for (auto &source : sources)
+	{
+		if (included_file_set.insert(source).second)
+		{
+			already_included_files.push_back(std::move(source));
+		}
+	}
+	structs.reserve(structs.size() + compiled_structs.size());
+	for (auto &s : compiled_structs)
+	{
+		addStruct(std::move(s));
+	}
+	enums.reserve(enums.size() + compiled_enums.size());
+	for (auto &e : compiled_enums)
+	{
+		addEnum(std::move(e));
+	}
+	return true;
 }
 
-bool ProgramStructure::generate_files(Generator *gen, std::string out_path)
+bool ProgramStructure::generate_files(Generator *gen, std::string out_path, OutputSink &sink)
 {
-	return gen->generate_files(*this, out_path);
+	return gen->generate_files(*this, out_path, sink);
 }
 
 std::vector<StructDefinition> &ProgramStructure::getStructs()
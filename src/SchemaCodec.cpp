@@ -0,0 +1,240 @@
+#include <SchemaCodec.hpp>
+#include <ProgramStructure.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+void write_member_variable(CacheWriter &w, const MemberVariableDefinition &mv)
+{
+	w.str(mv.type.identifier());
+	w.str(mv.type.element_type().identifier());
+	w.u8(mv.type.is_defaulted());
+	w.str(mv.identifier);
+	w.u8(mv.required);
+	w.u8(mv.auto_increment);
+	w.u8(mv.primary_key);
+	w.u8(mv.unique);
+	w.str(mv.reference.struct_name);
+	w.str(mv.reference.variable_name);
+	w.str(mv.description);
+	w.str(mv.default_value);
+	w.i32(mv.min_items);
+	w.i32(mv.max_items);
+	w.u8(mv.in_class_init);
+	w.u8((bool)mv.generate_initializer);
+	w.u8(mv.static_member);
+	w.u8(mv.const_member);
+	w.strings(mv.enabled_for_generators);
+	w.strings(mv.disabled_for_generators);
+}
+
+void read_member_variable(CacheReader &r, MemberVariableDefinition &mv)
+{
+	std::string type = r.str();
+	std::string element = r.str();
+	bool defaulted = r.u8();
+	mv.type = element.empty() ? TypeDefinition(type) : TypeDefinition(type, TypeDefinition(element));
+	mv.type.setDefaulted(defaulted);
+	mv.identifier = r.str();
+	mv.required = r.u8();
+	mv.auto_increment = r.u8();
+	mv.primary_key = r.u8();
+	mv.unique = r.u8();
+	mv.reference.struct_name = r.str();
+	mv.reference.variable_name = r.str();
+	mv.description = r.str();
+	mv.default_value = r.str();
+	mv.min_items = r.i32();
+	mv.max_items = r.i32();
+	mv.in_class_init = r.u8();
+	// the parser only ever installs the empty '{}' initializer
+	if (r.u8())
+	{
+		mv.generate_initializer = ProgramStructure::writeEmptyInitializer;
+	}
+	mv.static_member = r.u8();
+	mv.const_member = r.u8();
+	for (uint32_t i = 0, n = r.count(); i < n && r.ok; i++)
+	{
+		mv.enabled_for_generators.insert(r.str());
+	}
+	for (uint32_t i = 0, n = r.count(); i < n && r.ok; i++)
+	{
+		mv.disabled_for_generators.insert(r.str());
+	}
+}
+
+bool write_struct(CacheWriter &w, const StructDefinition &def)
+{
+	// generator functions can not be written to disk, the parser never adds any
+	if (!def.getFunctions().empty() || !def.getPrivateVariables().empty())
+	{
+		return false;
+	}
+	w.str(def.getIdentifier());
+	w.strings(def.getGensEnabled());
+	w.strings(def.getGensDisabled());
+	w.pairs(def.getIncludes());
+	w.pairs(def.getBeforeLines());
+	w.pairs(def.getBeforeSetterLines());
+	w.pairs(def.getBeforeGetterLines());
+	w.u32((uint32_t)def.getMemberVariables().size());
+	for (const auto &[generator, mv] : def.getMemberVariables())
+	{
+		w.str(generator);
+		write_member_variable(w, mv);
+	}
+	return true;
+}
+
+// members usually sit in the struct's file, which is then written as ""
+static void write_position(CacheWriter &w, const SourcePosition &position, FileId file_id)
+{
+	w.str(position.file_id == file_id ? std::string() : position.file_path());
+	w.i32(position.line);
+	w.i32(position.column);
+}
+
+static void read_position(CacheReader &r, SourcePosition &position, FileId file_id)
+{
+	std::string file = r.str();
+	position.file_id = file.empty() ? file_id : FileTable::instance().intern(file);
+	position.line = r.i32();
+	position.column = r.i32();
+}
+
+void write_positions(CacheWriter &w, const StructDefinition &def)
+{
+	write_position(w, def.position, 0);
+	w.u32((uint32_t)def.getMemberVariables().size());
+	for (const auto &[generator, mv] : def.getMemberVariables())
+	{
+		write_position(w, mv.position, def.position.file_id);
+	}
+}
+
+void read_positions(CacheReader &r, StructDefinition &def)
+{
+	read_position(r, def.position, 0);
+	if (r.u32() != def.getMemberVariables().size())
+	{
+		r.ok = false;
+		return;
+	}
+	for (auto &[generator, mv] : def.getMemberVariables())
+	{
+		read_position(r, mv.position, def.position.file_id);
+	}
+}
+
+void write_enum(CacheWriter &w, const EnumDefinition &e)
+{
+	w.str(e.identifier);
+	w.u32((uint32_t)e.values.size());
+	for (const auto &[name, value] : e.values)
+	{
+		w.str(name);
+		w.i32(value);
+	}
+	w.strings(e.enabled_for_generators);
+	w.strings(e.disabled_for_generators);
+}
+
+std::vector<std::string> read_strings(CacheReader &r)
+{
+	std::vector<std::string> values;
+	for (uint32_t i = 0, n = r.count(); i < n && r.ok; i++)
+	{
+		values.push_back(r.str());
+	}
+	return values;
+}
+
+void read_struct(CacheReader &r, StructDefinition &def)
+{
+	def.setIdentifier(r.str());
+	for (const auto &gen : read_strings(r))
+	{
+		def.add_gen_enabled(gen);
+	}
+	for (const auto &gen : read_strings(r))
+	{
+		def.add_gen_disabled(gen);
+	}
+	for (uint32_t i = 0, n = r.count(); i < n && r.ok; i++)
+	{
+		std::string generator = r.str();
+		def.add_include(r.str(), generator);
+	}
+	for (uint32_t i = 0, n = r.count(); i < n && r.ok; i++)
+	{
+		std::string generator = r.str();
+		def.add_before_line(r.str(), generator);
+	}
+	for (uint32_t i = 0, n = r.count(); i < n && r.ok; i++)
+	{
+		std::string generator = r.str();
+		def.add_before_setter_line(r.str(), generator);
+	}
+	for (uint32_t i = 0, n = r.count(); i < n && r.ok; i++)
+	{
+		std::string generator = r.str();
+		def.add_before_getter_line(r.str(), generator);
+	}
+	for (uint32_t i = 0, n = r.count(); i < n && r.ok; i++)
+	{
+		std::string generator = r.str();
+		MemberVariableDefinition mv;
+		read_member_variable(r, mv);
+		def.add_member_variable(std::move(mv), std::move(generator));
+	}
+}
+
+void read_enum(CacheReader &r, EnumDefinition &e)
+{
+	e.identifier = r.str();
+	for (uint32_t i = 0, n = r.count(); i < n && r.ok; i++)
+	{
+		std::string value = r.str();
+		e.add_value(value, r.i32());
+	}
+	for (const auto &gen : read_strings(r))
+	{
+		e.enabled_for_generators.insert(gen);
+	}
+	for (const auto &gen : read_strings(r))
+	{
+		e.disabled_for_generators.insert(gen);
+	}
+}
+
+bool writeFileAtomically(const std::string &path, std::string_view data)
+{
+	std::error_code ec;
+	std::ostringstream temp_name;
+	temp_name << path << ".tmp" << std::this_thread::get_id() << "." << std::chrono::steady_clock::now().time_since_epoch().count();
+	std::string temp = temp_name.str();
+	{
+		std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			return false;
+		}
+		file.write(data.data(), data.size());
+		if (!file)
+		{
+			file.close();
+			std::filesystem::remove(temp, ec);
+			return false;
+		}
+	}
+	std::filesystem::rename(temp, path, ec);
+	if (ec)
+	{
+		std::filesystem::remove(temp, ec);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,92 @@
+#include <SchemaWatcher.hpp>
+#include <algorithm>
+#include <filesystem>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <climits>
+#endif
+
+SchemaWatcher::~SchemaWatcher()
+{
+#ifdef __linux__
+	if (fd >= 0)
+	{
+		close(fd);
+	}
+#endif
+}
+
+bool SchemaWatcher::open()
+{
+#ifdef __linux__
+	fd = inotify_init1(IN_CLOEXEC);
+	return fd >= 0;
+#else
+	return false;
+#endif
+}
+
+bool SchemaWatcher::watchDirectory(const std::string &path)
+{
+#ifdef __linux__
+	std::string directory = path.empty() ? "." : path;
+	for (const auto &[wd, watched] : watched_directories)
+	{
+		if (watched == directory)
+		{
+			return true;
+		}
+	}
+	int wd = inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE);
+	if (wd < 0)
+	{
+		return false;
+	}
+	watched_directories[wd] = directory;
+	return true;
+#else
+	return false;
+#endif
+}
+
+std::vector<std::string> SchemaWatcher::wait(int settle_ms)
+{
+	std::vector<std::string> changed;
+#ifdef __linux__
+	alignas(inotify_event) char buffer[16 * (sizeof(inotify_event) + NAME_MAX + 1)];
+	int timeout = -1; // block for the first event
+	while (true)
+	{
+		pollfd pfd{fd, POLLIN, 0};
+		int ready = poll(&pfd, 1, timeout);
+		if (ready <= 0)
+		{
+			break;
+		}
+		ssize_t length = read(fd, buffer, sizeof(buffer));
+		if (length <= 0)
+		{
+			break;
+		}
+		for (char *p = buffer; p < buffer + length;)
+		{
+			inotify_event *event = reinterpret_cast<inotify_event *>(p);
+			auto it = watched_directories.find(event->wd);
+			if (it != watched_directories.end() && event->len > 0)
+			{
+				std::string path = (std::filesystem::path(it->second) / event->name).string();
+				if (std::find(changed.begin(), changed.end(), path) == changed.end())
+				{
+					changed.push_back(path);
+				}
+			}
+			p += sizeof(inotify_event) + event->len;
+		}
+		timeout = settle_ms;
+	}
+#endif
+	return changed;
+}
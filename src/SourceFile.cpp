@@ -0,0 +1,43 @@
+#include <SourceFile.hpp>
+#include <filesystem>
+
+bool SourceFile::open(const std::string &file_path)
+{
+	path = file_path;
+	contents = std::string_view();
+
+	std::error_code ec;
+	if (!std::filesystem::is_regular_file(file_path, ec))
+	{
+		return false;
+	}
+	auto file_size = std::filesystem::file_size(file_path, ec);
+	if (ec)
+	{
+		return false;
+	}
+	// a zero length region can not be mapped, an empty file simply has no text
+	if (file_size == 0)
+	{
+		return true;
+	}
+
+	try
+	{
+		mapping = boost::interprocess::file_mapping(file_path.c_str(), boost::interprocess::read_only);
+		region = boost::interprocess::mapped_region(mapping, boost::interprocess::read_only);
+	}
+	catch (const boost::interprocess::interprocess_exception &)
+	{
+		return false;
+	}
+	contents = std::string_view(static_cast<const char *>(region.get_address()), region.get_size());
+	return true;
+}
+
+void SourceFile::assign(const std::string &file_path, std::string text)
+{
+	path = file_path;
+	owned = std::move(text);
+	contents = owned;
+}
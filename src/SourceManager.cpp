@@ -0,0 +1,69 @@
+#include <SourceManager.hpp>
+#include <cstring>
+
+SourceBuffer *SourceManager::open(const std::string &file_path)
+{
+	auto buffer = std::make_unique<SourceBuffer>();
+	if (!buffer->file.open(file_path))
+	{
+		return nullptr;
+	}
+	return add(std::move(buffer));
+}
+
+SourceBuffer *SourceManager::open(const std::string &file_path, std::string text)
+{
+	auto buffer = std::make_unique<SourceBuffer>();
+	buffer->file.assign(file_path, std::move(text));
+	return add(std::move(buffer));
+}
+
+SourceBuffer *SourceManager::add(std::unique_ptr<SourceBuffer> buffer)
+{
+	const std::string &file_path = buffer->file.getPath();
+	std::string_view text = buffer->file.text();
+	buffer->line_starts.push_back(0);
+	const char *begin = text.data();
+	const char *end = begin + text.size();
+	for (const char *p = begin; p < end;)
+	{
+		const char *newline = static_cast<const char *>(memchr(p, '\n', end - p));
+		if (newline == nullptr)
+		{
+			break;
+		}
+		buffer->line_starts.push_back(newline + 1 - begin);
+		p = newline + 1;
+	}
+
+	SourceBuffer *result = buffer.get();
+	buffers.push_back(std::move(buffer));
+	buffers_by_file[FileTable::instance().intern(file_path)] = result;
+	return result;
+}
+
+const SourceBuffer *SourceManager::find(FileId file_id) const
+{
+	auto it = buffers_by_file.find(file_id);
+	if (it == buffers_by_file.end())
+	{
+		return nullptr;
+	}
+	return it->second;
+}
+
+std::string_view SourceManager::line(const SourceBuffer &buffer, int line_no)
+{
+	std::string_view text = buffer.file.text();
+	if (line_no < 1 || line_no > (int)buffer.line_starts.size() || buffer.line_starts[line_no - 1] >= text.size())
+	{
+		return std::string_view();
+	}
+	size_t line_start = buffer.line_starts[line_no - 1];
+	size_t line_end = text.find('\n', line_start);
+	if (line_end == std::string_view::npos)
+	{
+		line_end = text.size();
+	}
+	return text.substr(line_start, line_end - line_start);
+}
@@ -12,7 +12,7 @@ bool StructDefinition::add_before_line(std::string line, std::string generator)
 	if (has_before_line(line)) {
 		return false; // Before line already exists
 	}
-	before_lines.emplace_back(generator, line);
+	before_lines.emplace_back(std::move(generator), std::move(line));
 	return true;
 }
 
@@ -21,7 +21,7 @@ bool StructDefinition::add_before_setter_line(std::string line, std::string gene
 	if (has_before_setter_line(line)) {
 		return false; // Before setter line already exists
 	}
-	before_setter_lines.emplace_back(generator, line);
+	before_setter_lines.emplace_back(std::move(generator), std::move(line));
 	return true;
 }
 
@@ -30,13 +30,14 @@ bool StructDefinition::add_before_getter_line(std::string line, std::string gene
 	if (has_before_getter_line(line)) {
 		return false; // Before getter line already exists
 	}
-	before_getter_lines.emplace_back(generator, line);
+	before_getter_lines.emplace_back(std::move(generator), std::move(line));
 	return true;
 }
 
 bool StructDefinition::add_function(FunctionDefinition fd, std::string generator)
 {
-	functions.emplace_back(generator, fd);
+	function_names.insert(fd.identifier);
+	functions.emplace_back(std::move(generator), std::move(fd));
 	return true;
 }
 
@@ -45,7 +46,8 @@ bool StructDefinition::add_private_variable(PrivateVariableDefinition pv, std::s
 	if (has_private_variable(pv.identifier)) {
 		return false; // Private variable already exists
 	}
-	private_variables.emplace_back(generator, pv);
+	private_variable_names.insert(pv.identifier);
+	private_variables.emplace_back(std::move(generator), std::move(pv));
 	return true;
 }
 
@@ -54,18 +56,19 @@ bool StructDefinition::add_member_variable(MemberVariableDefinition mv, std::str
 	if (has_member_variable(mv.identifier)) {
 		return false; // Member variable already exists
 	}
-	member_variables.emplace_back(generator, mv);
+	member_variable_names.insert(mv.identifier);
+	member_variables.emplace_back(std::move(generator), std::move(mv));
 	return true;
 }
 
 bool StructDefinition::add_gen_enabled(std::string gen)
 {
-	enabled_for_generators.insert(gen);
+	enabled_for_generators.insert(std::move(gen));
 	return true;
 }
 
 bool StructDefinition::add_gen_disabled(std::string gen){
-	disabled_for_generators.insert(gen);
+	disabled_for_generators.insert(std::move(gen));
 	return true;
 }
 
@@ -109,34 +112,19 @@ bool StructDefinition::has_before_getter_line(std::string line)
 	return false;
 }
 
-bool StructDefinition::has_function(std::string identifier)
+bool StructDefinition::has_function(const std::string &identifier) const
 {
-	for (const auto& func : functions) {
-		if (func.second.identifier == identifier) {
-			return true; // Function exists
-		}
-	}
-	return false;
+	return function_names.count(identifier) != 0;
 }
 
-bool StructDefinition::has_private_variable(std::string identifier)
+bool StructDefinition::has_private_variable(const std::string &identifier) const
 {
-	for (const auto& pv : private_variables) {
-		if (pv.second.identifier == identifier) {
-			return true; // Private variable exists
-		}
-	}
-	return false;
+	return private_variable_names.count(identifier) != 0;
 }
 
-bool StructDefinition::has_member_variable(std::string identifier)
+bool StructDefinition::has_member_variable(const std::string &identifier) const
 {
-	for (const auto& mv : member_variables) {
-		if (mv.second.identifier == identifier) {
-			return true; // Member variable exists
-		}
-	}
-	return false;
+	return member_variable_names.count(identifier) != 0;
 }
 
 void StructDefinition::clear(){
@@ -147,6 +135,9 @@ void StructDefinition::clear(){
 	functions.clear();
 	private_variables.clear();
 	member_variables.clear();
+	function_names.clear();
+	private_variable_names.clear();
+	member_variable_names.clear();
 	identifier.clear();
 }
 
@@ -168,7 +159,7 @@ bool StructDefinition::blacklist(){
 	return !disabled_for_generators.empty();
 }
 
-void StructDefinition::update(StructDefinition def)
+void StructDefinition::update(const StructDefinition &def)
 {
 	// Merge
 	if (identifier!=def.identifier){
@@ -0,0 +1,31 @@
+#include <TemplateCache.hpp>
+#include <EmbeddedResources/EmbeddedResourcesEmbeddedVFS.hpp>
+
+TemplateCache &TemplateCache::instance()
+{
+	static TemplateCache cache;
+	return cache;
+}
+
+std::string_view TemplateCache::load(const std::string &path)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = files.find(path);
+	if (it == files.end())
+	{
+		std::vector<unsigned char> content = loadEmbeddedResourcesEmbeddedFile(path.c_str());
+		it = files.emplace(path, std::make_unique<std::string>(content.begin(), content.end())).first;
+	}
+	return *it->second;
+}
+
+const std::vector<std::string> &TemplateCache::list(const std::string &directory)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = listings.find(directory);
+	if (it == listings.end())
+	{
+		it = listings.emplace(directory, listEmbeddedResourcesEmbeddedFiles(directory.c_str())).first;
+	}
+	return it->second;
+}
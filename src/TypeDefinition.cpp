@@ -3,291 +3,151 @@
 
 TypeDefinition::TypeDefinition()
 {
-	ident = "";
-	elem_type = nullptr;
+	entry = TypeTable::instance().empty();
 }
 
-TypeDefinition::TypeDefinition(std::string ident)
+TypeDefinition::TypeDefinition(std::string_view ident)
 {
-	this->ident = ident;
-	this->elem_type = nullptr;
+	entry = TypeTable::instance().intern(ident);
 }
 
-TypeDefinition::TypeDefinition(std::string ident, bool defaulted)
+TypeDefinition::TypeDefinition(std::string_view ident, bool defaulted)
 {
-	this->ident = ident;
-	this->elem_type = nullptr;
+	entry = TypeTable::instance().intern(ident);
 	this->defaulted = defaulted;
 }
 
-TypeDefinition::TypeDefinition(std::string ident, TypeDefinition elem_type)
+TypeDefinition::TypeDefinition(std::string_view ident, TypeDefinition elem_type)
 {
-	this->ident = ident;
-	this->elem_type = new TypeDefinition(elem_type);
+	entry = TypeTable::instance().intern(ident, elem_type.entry);
 }
 
-std::string &TypeDefinition::identifier()
+const std::string &TypeDefinition::identifier() const
 {
-	return ident;
+	return entry->identifier;
 }
 
-bool TypeDefinition::is_array()
+void TypeDefinition::setIdentifier(std::string_view ident)
 {
-	return ident == ARRAY;
+	entry = TypeTable::instance().intern(ident, entry->element);
 }
 
-bool TypeDefinition::is_struct(ProgramStructure *ps)
+TypeKind TypeDefinition::kind(ProgramStructure *ps) const
 {
-	return ps->tokenIsStruct(ident);
+	return ps->getTypeKind(*this);
 }
 
-bool TypeDefinition::is_enum(ProgramStructure *ps)
+bool TypeDefinition::is_array() const
 {
-	return ps->tokenIsEnum(ident);
+	return entry->flags & TYPE_ARRAY;
 }
 
-bool TypeDefinition::is_base_type()
+bool TypeDefinition::is_struct(ProgramStructure *ps) const
 {
-	bool is_base = false;
-	if (ident == VOID)
-	{
-		is_base=true;
-	}
-	else if (ident == INT8)
-	{
-		is_base=true;
-	}
-	else if (ident == INT16)
-	{
-		is_base=true;
-	}
-	else if (ident == INT32)
-	{
-		is_base=true;
-	}
-	else if (ident == INT64)
-	{
-		is_base=true;
-	}
-	else if (ident == UINT8)
-	{
-		is_base=true;
-	}
-	else if (ident == UINT16)
-	{
-		is_base=true;
-	}
-	else if (ident == UINT32)
-	{
-		is_base=true;
-	}
-	else if (ident == UINT64)
-	{
-		is_base=true;
-	}
-	else if (ident == FLOAT)
-	{
-		is_base=true;
-	}
-	else if (ident == DOUBLE)
-	{
-		is_base=true;
-	}
-	else if (ident == BOOL)
-	{
-		is_base=true;
-	}
-	else if (ident == STRING)
-	{
-		is_base=true;
-	}
-	else if (ident == CHAR)
-	{
-		is_base=true;
-	}
-	else if (ident == UCHAR)
-	{
-		is_base=true;
-	}
-	else if (ident == POINTER)
-	{
-		is_base=true;
-	}
-	else if (ident == ARRAY)
-	{
-		is_base=true;
-	}
-	return is_base;
+	return ps->getTypeKind(*this) == TypeKind::Struct;
 }
 
-bool TypeDefinition::is_number()
+bool TypeDefinition::is_enum(ProgramStructure *ps) const
 {
-	bool is_number = false;
-	if (ident == INT8)
-	{
-		is_number=true;
-	}
-	else if (ident == INT16)
-	{
-		is_number=true;
-	}
-	else if (ident == INT32)
-	{
-		is_number=true;
-	}
-	else if (ident == INT64)
-	{
-		is_number=true;
-	}
-	else if (ident == UINT8)
-	{
-		is_number=true;
-	}
-	else if (ident == UINT16)
-	{
-		is_number=true;
-	}
-	else if (ident == UINT32)
-	{
-		is_number=true;
-	}
-	else if (ident == UINT64)
-	{
-		is_number=true;
-	}
-	else if (ident == FLOAT)
-	{
-		is_number=true;
-	}
-	else if (ident == DOUBLE)
-	{
-		is_number=true;
-	}
-	return is_number;
+	return ps->getTypeKind(*this) == TypeKind::Enum;
 }
 
-bool TypeDefinition::is_integer()
+bool TypeDefinition::is_base_type() const
 {
-	bool is_integer = false;
-	if (ident == INT8)
-	{
-		is_integer=true;
-	}
-	else if (ident == INT16)
-	{
-		is_integer=true;
-	}
-	else if (ident == INT32)
-	{
-		is_integer=true;
-	}
-	else if (ident == INT64)
-	{
-		is_integer=true;
-	}
-	else if (ident == UINT8)
-	{
-		is_integer=true;
-	}
-	else if (ident == UINT16)
-	{
-		is_integer=true;
-	}
-	else if (ident == UINT32)
-	{
-		is_integer=true;
-	}
-	else if (ident == UINT64)
-	{
-		is_integer=true;
-	}
-	return is_integer;
+	return entry->flags & TYPE_BASE;
 }
 
-bool TypeDefinition::is_real()
+bool TypeDefinition::is_number() const
 {
-	bool is_real = false;
-	if (ident == FLOAT)
-	{
-		is_real=true;
-	}
-	else if (ident == DOUBLE)
-	{
-		is_real=true;
-	}
-	return is_real;
+	return entry->flags & TYPE_NUMBER;
 }
 
-bool TypeDefinition::is_bool()
+bool TypeDefinition::is_integer() const
 {
-	return ident == BOOL;
+	return entry->flags & TYPE_INTEGER;
 }
 
-bool TypeDefinition::is_string()
+bool TypeDefinition::is_real() const
 {
-	return ident == STRING;
+	return entry->flags & TYPE_REAL;
 }
 
-bool TypeDefinition::is_char()
+bool TypeDefinition::is_bool() const
 {
-	return ident == CHAR;
+	return entry->flags & TYPE_BOOL;
 }
 
-bool TypeDefinition::is_array_of_struct(ProgramStructure *ps)
+bool TypeDefinition::is_string() const
 {
-	return elem_type != nullptr && elem_type->is_struct(ps);
+	return entry->flags & TYPE_STRING;
 }
 
-bool TypeDefinition::is_array_of_enum(ProgramStructure *ps)
+bool TypeDefinition::is_char() const
 {
-	return elem_type != nullptr && elem_type->is_enum(ps);
+	return entry->flags & TYPE_CHAR;
 }
 
-bool TypeDefinition::is_array_of_base_type()
+bool TypeDefinition::is_array_of_struct(ProgramStructure *ps) const
 {
-	return elem_type != nullptr && elem_type->is_base_type();
+	return entry->element != nullptr && element_type().is_struct(ps);
 }
 
-bool TypeDefinition::is_array_of_number()
+bool TypeDefinition::is_array_of_enum(ProgramStructure *ps) const
 {
-	return elem_type != nullptr && elem_type->is_number();
+	return entry->element != nullptr && element_type().is_enum(ps);
 }
 
-bool TypeDefinition::is_array_of_integer()
+bool TypeDefinition::is_array_of_base_type() const
 {
-	return elem_type != nullptr && elem_type->is_integer();
+	return entry->element != nullptr && (entry->element->flags & TYPE_BASE);
 }
 
-bool TypeDefinition::is_array_of_real()
+bool TypeDefinition::is_array_of_number() const
 {
-	return elem_type != nullptr && elem_type->is_real();
+	return entry->element != nullptr && (entry->element->flags & TYPE_NUMBER);
 }
 
-bool TypeDefinition::is_array_of_bool()
+bool TypeDefinition::is_array_of_integer() const
 {
-	return elem_type != nullptr && elem_type->is_bool();
+	return entry->element != nullptr && (entry->element->flags & TYPE_INTEGER);
 }
 
-bool TypeDefinition::is_array_of_string()
+bool TypeDefinition::is_array_of_real() const
 {
-	return elem_type != nullptr && elem_type->is_string();
+	return entry->element != nullptr && (entry->element->flags & TYPE_REAL);
 }
 
-bool TypeDefinition::is_array_of_char()
+bool TypeDefinition::is_array_of_bool() const
 {
-	return elem_type != nullptr && elem_type->is_char();
+	return entry->element != nullptr && (entry->element->flags & TYPE_BOOL);
 }
 
-bool TypeDefinition::is_optional()
+bool TypeDefinition::is_array_of_string() const
 {
-	return ident.find("std::optional<") == 0;
+	return entry->element != nullptr && (entry->element->flags & TYPE_STRING);
 }
 
-TypeDefinition &TypeDefinition::element_type()
+bool TypeDefinition::is_array_of_char() const
 {
-	if (elem_type == nullptr)
+	return entry->element != nullptr && (entry->element->flags & TYPE_CHAR);
+}
+
+bool TypeDefinition::is_optional() const
+{
+	return entry->flags & TYPE_OPTIONAL;
+}
+
+TypeDefinition TypeDefinition::element_type() const
+{
+	TypeDefinition elem;
+	if (entry->element != nullptr)
 	{
-		elem_type = new TypeDefinition();
+		elem.entry = entry->element;
 	}
-	return *elem_type;
-}
\ No newline at end of file
+	return elem;
+}
+
+void TypeDefinition::setElementType(TypeDefinition elem_type)
+{
+	entry = TypeTable::instance().intern(entry->identifier, elem_type.entry);
+}
@@ -0,0 +1,113 @@
+#include <TypeTable.hpp>
+#include <BaseTypes.hpp>
+
+static const std::unordered_map<std::string_view, unsigned> &base_type_flag_table()
+{
+	static const std::unordered_map<std::string_view, unsigned> flags = {
+		{VOID, TYPE_BASE},
+		{INT8, TYPE_BASE | TYPE_NUMBER | TYPE_INTEGER},
+		{INT16, TYPE_BASE | TYPE_NUMBER | TYPE_INTEGER},
+		{INT32, TYPE_BASE | TYPE_NUMBER | TYPE_INTEGER},
+		{INT64, TYPE_BASE | TYPE_NUMBER | TYPE_INTEGER},
+		{UINT8, TYPE_BASE | TYPE_NUMBER | TYPE_INTEGER},
+		{UINT16, TYPE_BASE | TYPE_NUMBER | TYPE_INTEGER},
+		{UINT32, TYPE_BASE | TYPE_NUMBER | TYPE_INTEGER},
+		{UINT64, TYPE_BASE | TYPE_NUMBER | TYPE_INTEGER},
+		{FLOAT, TYPE_BASE | TYPE_NUMBER | TYPE_REAL},
+		{DOUBLE, TYPE_BASE | TYPE_NUMBER | TYPE_REAL},
+		{BOOL, TYPE_BASE | TYPE_BOOL},
+		{STRING, TYPE_BASE | TYPE_STRING},
+		{CHAR, TYPE_BASE | TYPE_CHAR},
+		{UCHAR, TYPE_BASE},
+		{POINTER, TYPE_BASE},
+		{ARRAY, TYPE_BASE | TYPE_ARRAY}};
+	return flags;
+}
+
+static unsigned base_type_flags(std::string_view identifier)
+{
+	const auto &flags = base_type_flag_table();
+	auto it = flags.find(identifier);
+	if (it != flags.end())
+	{
+		return it->second;
+	}
+	if (identifier.find("std::optional<") == 0)
+	{
+		return TYPE_OPTIONAL;
+	}
+	return 0;
+}
+
+TypeTable::TypeTable()
+{
+	empty_type = add("", nullptr);
+	for (const auto &[identifier, flags] : base_type_flag_table())
+	{
+		const TypeEntry *entry = add(identifier, nullptr);
+		base_types.emplace(entry->identifier, entry);
+	}
+}
+
+TypeTable &TypeTable::instance()
+{
+	static TypeTable table;
+	return table;
+}
+
+const TypeEntry *TypeTable::intern(std::string_view identifier, const TypeEntry *element)
+{
+	if (element == nullptr)
+	{
+		if (identifier.empty())
+		{
+			return empty_type;
+		}
+		auto base = base_types.find(identifier);
+		if (base != base_types.end())
+		{
+			return base->second;
+		}
+	}
+	{
+		std::shared_lock<std::shared_mutex> lock(mutex);
+		auto it = lookup.find(Key{identifier, element});
+		if (it != lookup.end())
+		{
+			return it->second;
+		}
+	}
+	std::unique_lock<std::shared_mutex> lock(mutex);
+	// another thread may have added it since the shared lock was released
+	auto it = lookup.find(Key{identifier, element});
+	if (it != lookup.end())
+	{
+		return it->second;
+	}
+	return add(identifier, element);
+}
+
+const TypeEntry *TypeTable::add(std::string_view identifier, const TypeEntry *element)
+{
+	TypeEntry &entry = entries.emplace_back();
+	entry.identifier = std::string(identifier);
+	entry.element = element;
+	entry.flags = base_type_flags(identifier);
+	entry.id = entries.size() - 1;
+	if (entry.flags & TYPE_ARRAY)
+	{
+		entry.kind = TypeKind::Array;
+	}
+	else if (entry.flags & TYPE_BASE)
+	{
+		entry.kind = TypeKind::Base;
+	}
+	lookup.emplace(Key{entry.identifier, element}, &entry);
+	return &entry;
+}
+
+size_t TypeTable::size()
+{
+	std::shared_lock<std::shared_mutex> lock(mutex);
+	return entries.size();
+}
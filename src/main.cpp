@@ -1,8 +1,18 @@
 #include <iostream>
 #include <filesystem>
 #include <vector>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
 #include <ArgParser/ArgParser.hpp>
 #include <ProgramStructure.hpp>
+#include <SchemaWatcher.hpp>
+#include <LanguageServer.hpp>
+#include <OutputCapture.hpp>
+#include <OutputManifest.hpp>
+#include <OutputSink.hpp>
+#include <ParallelFor.hpp>
+#include <TemplateCache.hpp>
 #include <BuiltInGenerators/CppGenerator.hpp>
 #include <BuiltInGenerators/JavaGenerator.hpp>
 #include <BuiltInGenerators/JsonGenerator.hpp>
@@ -13,6 +23,80 @@
 #include <boost/function.hpp>
 #include <EmbeddedResources/EmbeddedResourcesEmbeddedVFS.hpp>
 
+// names of the structs and enums that differ between two models, plus every
+// struct whose generated files depend on one of them. removed is set when a
+// definition of before is missing from after.
+static std::vector<std::string> changed_definitions(ProgramStructure &before, ProgramStructure &after, bool &removed)
+{
+	std::map<std::string, uint64_t> old_fingerprints;
+	std::map<std::string, uint64_t> new_fingerprints;
+	for (auto &s : before.getStructs())
+	{
+		old_fingerprints["struct " + s.getIdentifier()] = ParseCache::fingerprint(s);
+	}
+	for (auto &e : before.getEnums())
+	{
+		old_fingerprints["enum " + e.identifier] = ParseCache::fingerprint(e);
+	}
+	for (auto &s : after.getStructs())
+	{
+		new_fingerprints["struct " + s.getIdentifier()] = ParseCache::fingerprint(s);
+	}
+	for (auto &e : after.getEnums())
+	{
+		new_fingerprints["enum " + e.identifier] = ParseCache::fingerprint(e);
+	}
+
+	std::set<std::string> changed;
+	for (const auto &[key, fingerprint] : new_fingerprints)
+	{
+		auto it = old_fingerprints.find(key);
+		if (it == old_fingerprints.end() || it->second != fingerprint)
+		{
+			changed.insert(key.substr(key.find(' ') + 1));
+		}
+	}
+	removed = false;
+	for (const auto &[key, fingerprint] : old_fingerprints)
+	{
+		if (new_fingerprints.count(key) == 0)
+		{
+			changed.insert(key.substr(key.find(' ') + 1));
+			removed = true;
+		}
+	}
+
+	// a struct also changes when anything its members use or reference
+	// changed, and when a struct holding an array of it changed, because the
+	// SQL generators give it a column for that parent
+	std::set<std::string> struct_names;
+	for (auto &s : after.getStructs())
+	{
+		struct_names.insert(s.getIdentifier());
+	}
+	bool grew = !changed.empty();
+	while (grew)
+	{
+		grew = false;
+		for (auto &s : after.getStructs())
+		{
+			for (auto &[generator, mv] : s.getMemberVariables())
+			{
+				std::string element = mv.type.element_type().identifier();
+				if (changed.count(mv.type.identifier()) != 0 || changed.count(element) != 0 || changed.count(mv.reference.struct_name) != 0)
+				{
+					grew = changed.insert(s.getIdentifier()).second || grew;
+				}
+				if (mv.type.is_array() && struct_names.count(element) != 0 && changed.count(s.getIdentifier()) != 0)
+				{
+					grew = changed.insert(element).second || grew;
+				}
+			}
+		}
+	}
+	return std::vector<std::string>(changed.begin(), changed.end());
+}
+
 int main(int argc, char *argv[])
 {
 	if(!initEmbeddedResourcesEmbeddedVFS(argv[0])){
@@ -26,7 +110,10 @@ int main(int argc, char *argv[])
 
 	std::filesystem::path schemaDirectory;
 	std::filesystem::path schemaFile;
+	std::filesystem::path compiledFile;
+	std::filesystem::path emitCompiledFile;
 	std::filesystem::path outputDirectory;
+	std::filesystem::path outputArchive;
 	std::filesystem::path additionalGeneratorsDirectory;
 	bool EnableExponentialOperations = false;
 	bool recursive = false;
@@ -95,6 +182,12 @@ int main(int argc, char *argv[])
 											registerArguments(&ap);
 											std::cout << "Registered arguments for generator '" << generatorName << "' from: " << entry.path().string() << std::endl;
 										}
+
+										if (lib.has("setTemplateCache"))
+										{
+											auto setTemplateCache = lib.get<void(TemplateCache*)>("setTemplateCache");
+											setTemplateCache(&TemplateCache::instance());
+										}
 									}
 									else
 									{
@@ -142,75 +235,108 @@ int main(int argc, char *argv[])
 		{ cppGenerator->set_use_angle_brackets(true); });
 	ap.addFlag(&cppUseAngleBracketsFlag);
 
+	// thread counts, 0 = one per core
+	auto parseJobs = [](const std::string &name, const std::string &value)
+	{
+		char *end = nullptr;
+		unsigned long jobs = strtoul(value.c_str(), &end, 10);
+		if (value.empty() || *end != '\0')
+		{
+			std::cout << "Error: -" << name << " expects a number, got: " << value << std::endl;
+			exit(1);
+		}
+		return (unsigned)jobs;
+	};
+
+	// how many generators run at the same time
+	unsigned generatorJobs = 1;
+	Parameter jobsParameter("jobs", false, [&](std::string value)
+		{ generatorJobs = parseJobs("jobs", value); });
+	ap.addParameter(&jobsParameter);
+
+	// how many threads the C++ generator renders structs and enums with,
+	// independent of -jobs
+	Parameter cppJobsParameter("cppJobs", false, [&](std::string value)
+		{ cppGenerator->set_jobs(parseJobs("cppJobs", value)); });
+	ap.addParameter(&cppJobsParameter);
+
 	Flag javaFlag("java", false, [&]
 				  {
 					  // Java generator flag - just enables Java generation
 				  });
 	ap.addFlag(&javaFlag);
 
-	Parameter schemaDirectoryParameter("schemaDirectory", false, [&](std::string value)
-									   { 
-										schemaDirectory = value; 
-									// generate classes for each schema file
-	if (recursive)
+	// prints the per file result of ps.readFiles and stops at the first failure
+	auto reportFileRead = [](const std::string &path, bool ok)
 	{
-		for (const auto &entry : std::filesystem::recursive_directory_iterator(schemaDirectory))
+		if (!ok)
 		{
-			if (entry.is_directory())
-			{
-				printf("File is a directory entering: %s\n", entry.path().string().c_str());
-				continue;
-			}
-			if (!entry.path().has_extension())
-			{
-				printf("File has no extension: %s\n", entry.path().string().c_str());
-				continue;
-			}
-			if (!(entry.path().extension().compare(".schema") || entry.path().extension().compare(".schemaLang")))
-			{
-				printf("File is not a schema file: %s\n", entry.path().string().c_str());
-				continue;
-			}
-			if (!ps.readFile(entry.path().string()))
-			{
-				std::cout << "Failed to read file: " << entry.path().string() << std::endl;
-				exit(1);
-			}
-			else
-			{
-				std::cout << "Read file: " << entry.path().string() << std::endl;
-			}
+			std::cout << "Failed to read file: " << path << std::endl;
 		}
-	}
-	else
+		else
+		{
+			std::cout << "Read file: " << path << std::endl;
+		}
+	};
+
+	// lists the schema files in schemaDirectory in a stable order
+	auto collectSchemaFiles = [&](bool quiet)
 	{
-		for (const auto &entry : std::filesystem::directory_iterator(schemaDirectory))
+		std::vector<std::string> schemaFiles;
+		auto collectSchemaFile = [&](const std::filesystem::directory_entry &entry)
 		{
 			if (entry.is_directory())
 			{
-				printf("File is a directory entering: %s\n", entry.path().string().c_str());
-				continue;
+				if (!quiet)
+				{
+					printf("File is a directory entering: %s\n", entry.path().string().c_str());
+				}
+				return;
 			}
 			if (!entry.path().has_extension())
 			{
-				printf("File has no extension: %s\n", entry.path().string().c_str());
-				continue;
+				if (!quiet)
+				{
+					printf("File has no extension: %s\n", entry.path().string().c_str());
+				}
+				return;
 			}
 			if (!(entry.path().extension().compare(".schema") || entry.path().extension().compare(".schemaLang")))
 			{
-				printf("File is not a schema file: %s\n", entry.path().string().c_str());
-				continue;
+				if (!quiet)
+				{
+					printf("File is not a schema file: %s\n", entry.path().string().c_str());
+				}
+				return;
 			}
-			if (!ps.readFile(entry.path().string()))
+			schemaFiles.push_back(entry.path().string());
+		};
+		if (recursive)
+		{
+			for (const auto &entry : std::filesystem::recursive_directory_iterator(schemaDirectory))
 			{
-				std::cout << "Failed to read file: " << entry.path().string() << std::endl;
-				exit(1);
+				collectSchemaFile(entry);
 			}
-			else
+		}
+		else
+		{
+			for (const auto &entry : std::filesystem::directory_iterator(schemaDirectory))
 			{
-				std::cout << "Read file: " << entry.path().string() << std::endl;
+				collectSchemaFile(entry);
 			}
 		}
+		// directory order depends on the file system, merge in a stable order
+		std::sort(schemaFiles.begin(), schemaFiles.end());
+		return schemaFiles;
+	};
+
+	Parameter schemaDirectoryParameter("schemaDirectory", false, [&](std::string value)
+									   { 
+										schemaDirectory = value; 
+									// lex and parse the schema files in parallel
+	if (!ps.readFiles(collectSchemaFiles(false), 0, reportFileRead))
+	{
+		exit(1);
 	} }, 4);
 	ap.addParameter(&schemaDirectoryParameter);
 
@@ -229,20 +355,35 @@ int main(int argc, char *argv[])
 				printf("File is not a schema file: %s\n", schemaFile.string().c_str());
 				return;
 			}
-			if (!ps.readFile(schemaFile.string()))
+			if (!ps.readFiles({schemaFile.string()}, 0, reportFileRead))
 			{
-				std::cout << "Failed to read file: " << schemaFile.string() << std::endl;
 				exit(1);
 			}
-			else
+		}, 4);
+	ap.addParameter(&schemaFileParameter);
+
+	// compiled schema image written by -emitCompiled, loaded without parsing
+	Parameter compiledParameter("compiled", false, [&](std::string value)
+		{
+			compiledFile = value;
+			if (!ps.readCompiled(value))
 			{
-				std::cout << "Read file: " << schemaFile.string() << std::endl;
+				std::cout << "Failed to read compiled schema: " << value << std::endl;
+				exit(1);
 			}
+			std::cout << "Read compiled schema: " << value << std::endl;
 		}, 4);
-	ap.addParameter(&schemaFileParameter);
+	ap.addParameter(&compiledParameter);
+	Parameter emitCompiledParameter("emitCompiled", false, [&](std::string value)
+		{ emitCompiledFile = value; });
+	ap.addParameter(&emitCompiledParameter);
 	Parameter outputDirectoryParameter("outputDirectory", true, [&](std::string value)
 									   { outputDirectory = value; outputDirectory = outputDirectory / "Schemas";; });
 	ap.addParameter(&outputDirectoryParameter);
+	// pack the generated files into one tar archive instead of the output directory
+	Parameter outputArchiveParameter("outputArchive", false, [&](std::string value)
+		{ outputArchive = value; });
+	ap.addParameter(&outputArchiveParameter);
 
 	// flags for exponentiall opperations
 	Flag enableExponentialOperationsFlag("enableExponentialOperations", false, [&]()
@@ -289,6 +430,31 @@ int main(int argc, char *argv[])
 		mysqlGenerator->set_generate_delete_files(true); }, 2);
 	ap.addFlag(&deleteFilesFlag);
 
+	// parse cache, has to be configured before the schema callbacks (priority 4) run
+	ps.parse_cache = std::make_shared<ParseCache>(".schemalang-cache", ProgramStructure::parserVersion());
+	Parameter parseCacheDirectoryParameter("parseCacheDirectory", false, [&](std::string value)
+										   { ps.parse_cache->setDirectory(value); }, 5);
+	ap.addParameter(&parseCacheDirectoryParameter);
+	Flag noParseCacheFlag("noParseCache", false, [&]()
+						  { ps.parse_cache.reset(); }, 5);
+	ap.addFlag(&noParseCacheFlag);
+
+	// keep running and regenerate whenever a schema file changes
+	Flag watchFlag("watch", false);
+	ap.addFlag(&watchFlag);
+
+	// list every generated file instead of only the totals
+	Flag verboseFlag("verbose", false, [&]()
+					 { OutputManifest::instance().setVerbose(true); });
+	ap.addFlag(&verboseFlag);
+
+	// language server on stdin / stdout, runs before any schema is read and never returns
+	Flag lspFlag("lsp", false, [&]()
+				 {
+		LanguageServer server;
+		exit(server.run(std::cin, std::cout)); }, 7);
+	ap.addFlag(&lspFlag);
+
 	// -R for recursive directory iterator
 	Flag recursiveFlag("R", false, [&]()
 					   { recursive = true; }, 6);
@@ -353,9 +519,9 @@ int main(int argc, char *argv[])
 	}
 
 	// Ensure at least one input source was provided
-	if (schemaFile.empty() && schemaDirectory.empty())
+	if (schemaFile.empty() && schemaDirectory.empty() && compiledFile.empty())
 	{
-		std::cout << "Error: No schema input provided. Use -schemaDirectory=<path> or -schema=<file>." << std::endl;
+		std::cout << "Error: No schema input provided. Use -schemaDirectory=<path>, -schema=<file> or -compiled=<file>." << std::endl;
 		return 1;
 	}
 
@@ -369,74 +535,251 @@ int main(int argc, char *argv[])
 		}
 	}
 
-	if (jsonFlag.getValue())
+	if (!emitCompiledFile.empty())
 	{
-		printf("Generating json files\n");
-		if (!ps.generate_files(jsonGenerator, (outputDirectory / "Json").string()))
+		if (!ps.writeCompiled(emitCompiledFile.string()))
 		{
-			std::cout << "Failed to generate json files" << std::endl;
+			std::cout << "Failed to write compiled schema: " << emitCompiledFile.string() << std::endl;
 			return 1;
 		}
+		std::cout << "Wrote compiled schema: " << emitCompiledFile.string() << std::endl;
 	}
 
-	if (luaFlag.getValue())
+	// every enabled generator and the subdirectory it writes to. The wiring
+	// above is complete at this point and nothing calls add_generator while
+	// they run, so generators only read each other and the shared ps.
+	struct GeneratorRun
 	{
-		printf("Generating lua files\n");
-		if (!ps.generate_files(luaGenerator, (outputDirectory / "Lua").string()))
+		Generator *generator;
+		std::string directory;
+		std::string started;
+		std::string failed;
+	};
+	std::vector<GeneratorRun> generatorRuns;
+	auto addRun = [&](bool enabled, Generator *generator, const std::string &directory, const std::string &label)
+	{
+		if (enabled)
 		{
-			std::cout << "Failed to generate lua files" << std::endl;
-			return 1;
+			generatorRuns.push_back({generator, directory, "Generating " + label + " files", "Failed to generate " + label + " files"});
 		}
+	};
+	addRun(jsonFlag.getValue(), jsonGenerator, "Json", "json");
+	addRun(luaFlag.getValue(), luaGenerator, "Lua", "lua");
+	addRun(sqliteFlag.getValue(), sqliteGenerator, "Sqlite", "sqlite");
+	addRun(mysqlFlag.getValue(), mysqlGenerator, "Mysql", "mysql");
+	addRun(cppFlag.getValue(), cppGenerator, "Cpp", "cpp");
+	addRun(javaFlag.getValue(), javaGenerator, "Java", "java");
+	for (size_t i = 0; i < dynamicGenerators.size(); i++)
+	{
+		generatorRuns.push_back({dynamicGenerators[i], dynamicGeneratorNames[i],
+								 "Generating files for dynamic generator '" + dynamicGeneratorNames[i] + "'",
+								 "Failed to generate files for dynamic generator '" + dynamicGeneratorNames[i] + "'"});
 	}
 
-	if (sqliteFlag.getValue())
+	// where the generated files go, archive entries are named like the files
+	// would be below -outputDirectory
+	std::unique_ptr<OutputSink> sink;
+	if (!outputArchive.empty())
 	{
-		printf("Generating sqlite files\n");
-		if (!ps.generate_files(sqliteGenerator, (outputDirectory / "Sqlite").string()))
-		{
-			std::cout << "Failed to generate sqlite files" << std::endl;
-			return 1;
-		}
+		sink = std::make_unique<ArchiveSink>(outputArchive.string(), outputDirectory.parent_path().string());
+	}
+	else
+	{
+		sink = std::make_unique<FileSystemSink>();
 	}
 
-	if (mysqlFlag.getValue())
+	// runs the generators over ps on up to generatorJobs threads. What each one
+	// prints is held back and printed in the order above, stopping at the first
+	// generator that fails; generators after it that have not started are skipped.
+	auto generateAll = [&]() -> bool
 	{
-		printf("Generating mysql files\n");
-		if (!ps.generate_files(mysqlGenerator, (outputDirectory / "Mysql").string()))
+		auto startTime = std::chrono::steady_clock::now();
+		OutputCapture::install();
+		size_t count = generatorRuns.size();
+		std::vector<std::string> output(count);
+		std::vector<char> finished(count, false);
+		std::vector<char> succeeded(count, false);
+		std::mutex printMutex;
+		size_t printed = 0;
+		size_t firstFailure = count;
+
+		parallelFor(count, generatorJobs, [&](size_t i)
+					{
+			{
+				std::lock_guard<std::mutex> lock(printMutex);
+				if (i > firstFailure)
+				{
+					finished[i] = true;
+					return;
+				}
+			}
+			bool ok;
+			{
+				OutputCapture capture(output[i]);
+				std::string outPath = (outputDirectory / generatorRuns[i].directory).string();
+				ok = ps.generate_files(generatorRuns[i].generator, outPath, *sink);
+				// a -watch rebuild of some definitions leaves the files of the others
+				// alone, so only a full run can tell which files are stale
+				if (ok && ps.render_only.empty())
+				{
+					sink->complete(outPath);
+				}
+			}
+			std::lock_guard<std::mutex> lock(printMutex);
+			finished[i] = true;
+			succeeded[i] = ok;
+			if (!ok && i < firstFailure)
+			{
+				firstFailure = i;
+			}
+			for (; printed < count && printed <= firstFailure && finished[printed]; printed++)
+			{
+				std::cout << generatorRuns[printed].started << "\n"
+						  << output[printed];
+				if (!succeeded[printed])
+				{
+					std::cout << generatorRuns[printed].failed << "\n";
+				}
+				std::cout << std::flush;
+			} });
+		// for the file system this waits for the background writer, deletes files
+		// of removed definitions and remembers what was written, so the next run
+		// can skip unchanged files
+		OutputTotals totals;
+		bool saved = sink->finish(totals);
+		auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+		std::cout << "Generated " << totals.written + totals.unchanged << " files (" << totals.written << " written, "
+				  << totals.unchanged << " unchanged";
+		if (totals.removed > 0)
 		{
-			std::cout << "Failed to generate mysql files" << std::endl;
-			return 1;
+			std::cout << ", " << totals.removed << " stale removed";
 		}
+		if (totals.failed > 0)
+		{
+			std::cout << ", " << totals.failed << " failed";
+		}
+		std::cout << ") in " << elapsed.count() << " ms" << std::endl;
+		return firstFailure == count && saved;
+	};
+
+	if (!generateAll())
+	{
+		return 1;
 	}
 
-	if (cppFlag.getValue())
+	if (watchFlag.getValue())
 	{
-		printf("Generating cpp files\n");
-		if (!ps.generate_files(cppGenerator, (outputDirectory / "Cpp").string()))
+		if (schemaFile.empty() && schemaDirectory.empty())
 		{
-			std::cout << "Failed to generate cpp files" << std::endl;
+			std::cout << "Error: -watch needs -schemaDirectory=<path> or -schema=<file>, a compiled schema does not change." << std::endl;
 			return 1;
 		}
-	}
-
-	if (javaFlag.getValue())
-	{
-		printf("Generating java files\n");
-		if (!ps.generate_files(javaGenerator, (outputDirectory / "Java").string()))
+		SchemaWatcher watcher;
+		if (!watcher.open())
 		{
-			std::cout << "Failed to generate java files" << std::endl;
+			std::cout << "Error: -watch is not supported on this platform." << std::endl;
 			return 1;
 		}
-	}
+		// parses of unchanged files are reused from memory on every rebuild
+		if (!ps.parse_cache)
+		{
+			ps.parse_cache = std::make_shared<ParseCache>("", ProgramStructure::parserVersion());
+		}
+		ps.parse_cache->setKeepInMemory(true);
 
-	// Generate files for dynamic generators
-	for (size_t i = 0; i < dynamicGenerators.size(); i++)
-	{
-		printf("Generating files for dynamic generator '%s'\n", dynamicGeneratorNames[i].c_str());
-		if (!ps.generate_files(dynamicGenerators[i], (outputDirectory / dynamicGeneratorNames[i]).string()))
+		// the schema directory and the directory of every file that was read, includes too
+		auto watchInputs = [&]()
 		{
-			std::cout << "Failed to generate files for dynamic generator '" << dynamicGeneratorNames[i] << "'" << std::endl;
-			return 1;
+			if (!schemaDirectory.empty())
+			{
+				watcher.watchDirectory(schemaDirectory.string());
+				if (recursive)
+				{
+					for (const auto &entry : std::filesystem::recursive_directory_iterator(schemaDirectory))
+					{
+						if (entry.is_directory())
+						{
+							watcher.watchDirectory(entry.path().string());
+						}
+					}
+				}
+			}
+			for (const auto &file : ps.already_included_files)
+			{
+				watcher.watchDirectory(std::filesystem::path(file).parent_path().string());
+			}
+		};
+		watchInputs();
+		std::cout << "Watching for schema changes, press Ctrl+C to stop." << std::endl;
+
+		while (true)
+		{
+			bool schemaChanged = false;
+			for (const auto &path : watcher.wait())
+			{
+				std::filesystem::path changedPath(path);
+				bool isInput = ps.included_file_set.count(path) != 0;
+				if (isInput || changedPath.extension() == ".schema" || changedPath.extension() == ".schemaLang")
+				{
+					std::cout << "Changed: " << path << std::endl;
+					schemaChanged = true;
+				}
+			}
+			if (!schemaChanged)
+			{
+				continue;
+			}
+
+			ProgramStructure updated;
+			updated.parse_cache = ps.parse_cache;
+			if (!compiledFile.empty() && !updated.readCompiled(compiledFile.string()))
+			{
+				std::cout << "Failed to read compiled schema: " << compiledFile.string() << std::endl;
+				continue;
+			}
+			std::vector<std::string> inputs = schemaDirectory.empty() ? std::vector<std::string>{schemaFile.string()} : collectSchemaFiles(true);
+			if (!updated.readFiles(inputs, 0, [](const std::string &path, bool ok)
+				{
+					if (!ok)
+					{
+						std::cout << "Failed to read file: " << path << std::endl;
+					} }))
+			{
+				std::cout << "Schema has errors, waiting for the next change." << std::endl;
+				continue;
+			}
+
+			bool definitionsRemoved = false;
+			std::vector<std::string> changedDefinitions = changed_definitions(ps, updated, definitionsRemoved);
+			ps = updated;
+			watchInputs();
+			if (changedDefinitions.empty())
+			{
+				std::cout << "No definitions changed." << std::endl;
+				continue;
+			}
+			std::string names;
+			for (const auto &name : changedDefinitions)
+			{
+				names += (names.empty() ? "" : ", ") + name;
+			}
+			// the files of removed definitions are deleted by a full run, which
+			// removes whatever it did not produce again
+			if (definitionsRemoved)
+			{
+				std::cout << "Regenerating all files, definitions changed or removed: " << names << std::endl;
+			}
+			else
+			{
+				std::cout << "Regenerating files of changed definitions: " << names << std::endl;
+				ps.render_only.insert(changedDefinitions.begin(), changedDefinitions.end());
+			}
+			bool generated = generateAll();
+			ps.render_only.clear();
+			if (!generated)
+			{
+				std::cout << "Generation failed, waiting for the next change." << std::endl;
+			}
 		}
 	}
 
@@ -0,0 +1,270 @@
+#include <ProgramStructure.hpp>
+#include <LexScan.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+// Differential test of ProgramStructure::tokenizeWithPosition against the
+// lexer it replaced, which classified every character with if-chains. Both
+// lex the same randomized inputs and must agree on every token value, line,
+// column and index, and on where an unterminated comment is reported. The
+// build compiles this once per scanner path (see tests/CMakeLists.txt).
+// Usage: LexerDiffTest [iterations] [seed]
+
+struct LegacyToken
+{
+	std::string value;
+	int line;
+	int column;
+	int index;
+};
+
+static bool legacyIsBreakChar(char c)
+{
+	return c == ' ' || c == '\n' || c == '\t';
+}
+
+static bool legacyIsSpecialBreakChar(char c)
+{
+	return c == '{' || c == '}' || c == '(' || c == ')' || c == ',' || c == ';' || c == ':' || c == '<' || c == '>' || c == '=' || c == '.';
+}
+
+// the previous tokenizeWithPosition, unchanged apart from reporting the
+// unterminated comment through error_line / error_column
+static std::vector<LegacyToken> legacyTokenize(const std::string &str, int &error_line, int &error_column)
+{
+	std::vector<LegacyToken> tokens;
+	int line = 1;
+	int column = 1;
+	bool in_string = false;
+	bool skip_next = false;
+	std::string token;
+	error_line = 0;
+	error_column = 0;
+
+	auto emit_token = [&]()
+	{
+		if (!token.empty())
+		{
+			tokens.push_back({token, line, column, (int)tokens.size()});
+		}
+		token.clear();
+	};
+
+	for (size_t idx = 0; idx < str.size();)
+	{
+		char c = str[idx];
+		char next = (idx + 1 < str.size() ? str[idx + 1] : '\0');
+
+		if (!in_string && c == '/' && next == '/')
+		{
+			idx += 2;
+			column += 2;
+			while (idx < str.size() && str[idx] != '\n')
+			{
+				idx++;
+				column++;
+			}
+			if (idx < str.size() && str[idx] == '\n')
+			{
+				line++;
+				column = 1;
+				idx++;
+			}
+			continue;
+		}
+		if (!in_string && c == '/' && next == '*')
+		{
+			idx += 2;
+			column += 2;
+			bool found_end = false;
+			while (idx < str.size())
+			{
+				if (str[idx] == '\n')
+				{
+					line++;
+					column = 1;
+					idx++;
+					continue;
+				}
+				if (str[idx] == '*' && idx + 1 < str.size() && str[idx + 1] == '/')
+				{
+					idx += 2;
+					column += 2;
+					found_end = true;
+					break;
+				}
+				idx++;
+				column++;
+			}
+			if (!found_end)
+			{
+				error_line = line;
+				error_column = column;
+				return tokens;
+			}
+			continue;
+		}
+
+		if (c == '\\')
+		{
+			skip_next = true;
+			column++;
+			idx++;
+			continue;
+		}
+		if (skip_next)
+		{
+			skip_next = false;
+			column++;
+			idx++;
+			continue;
+		}
+
+		if (c == '"')
+		{
+			in_string = !in_string;
+			if (!in_string)
+			{
+				emit_token();
+			}
+			column++;
+			idx++;
+			continue;
+		}
+		if (!in_string)
+		{
+			if (legacyIsBreakChar(c) || legacyIsSpecialBreakChar(c))
+			{
+				emit_token();
+				if (legacyIsSpecialBreakChar(c))
+				{
+					tokens.push_back({std::string(1, c), line, column, (int)tokens.size()});
+				}
+				if (c == '\n')
+				{
+					line++;
+					column = 1;
+				}
+				else
+				{
+					column++;
+				}
+				idx++;
+				continue;
+			}
+		}
+		token += c;
+		column++;
+		idx++;
+	}
+	emit_token();
+	return tokens;
+}
+
+// pieces that hit every branch of both lexers, including runs long enough
+// for the 16 and 32 byte scanner blocks and runs that end inside a block
+static const char *const pieces[] = {
+	"identifier_with_many_chars_0123456789", "x", "42", "                                        ", "\t\t", "\n", "\r\n", "\r",
+	"\"", "\\", "//", "/*", "*/", "/", "*", "{", "}", "(", ")", ",", ";", ":", "<", ">", "=", ".", "-",
+	"\xc3\xa9", "\xff", "\x80", "\"long string body with // and /* inside and more than thirty two bytes\"",
+	"struct Player {\n\tuint32: id primary_key;\n\tstring: name;\n}\n", "enum Color { Red, Green }"};
+
+static std::string randomInput(std::mt19937 &random)
+{
+	std::string input;
+	size_t count = random() % 120;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (random() % 16 == 0)
+		{
+			input += (char)(random() % 256);
+		}
+		else
+		{
+			input += pieces[random() % (sizeof(pieces) / sizeof(pieces[0]))];
+		}
+	}
+	return input;
+}
+
+static const char *scannerPath()
+{
+#if defined(LEX_SCAN_AVX2)
+	return "AVX2";
+#elif defined(LEX_SCAN_SSE2)
+	return "SSE2";
+#else
+	return "scalar";
+#endif
+}
+
+static void printInput(const std::string &input)
+{
+	for (unsigned char c : input)
+	{
+		if (c >= 0x20 && c < 0x7f && c != '\\')
+		{
+			putchar(c);
+		}
+		else
+		{
+			printf("\\x%02x", c);
+		}
+	}
+	printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+#if defined(LEX_SCAN_AVX2) && (defined(__GNUC__) || defined(__clang__))
+	if (!__builtin_cpu_supports("avx2"))
+	{
+		printf("Skipped: this CPU has no AVX2\n");
+		return 77;
+	}
+#endif
+	unsigned long iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 20000;
+	unsigned long seed = argc > 2 ? strtoul(argv[2], nullptr, 10) : 1;
+	std::mt19937 random((std::mt19937::result_type)seed);
+
+	for (unsigned long iteration = 0; iteration < iterations; iteration++)
+	{
+		std::string input = randomInput(random);
+
+		int error_line = 0;
+		int error_column = 0;
+		std::vector<LegacyToken> expected = legacyTokenize(input, error_line, error_column);
+
+		ProgramStructure ps;
+		std::string diagnostics;
+		ps.diagnostics = &diagnostics;
+		std::vector<Token> actual = ps.tokenizeWithPosition(input, "lexer_test.schema");
+
+		bool same = expected.size() == actual.size();
+		for (size_t i = 0; same && i < expected.size(); i++)
+		{
+			same = expected[i].value == actual[i].value && expected[i].line == actual[i].position.line &&
+				   expected[i].column == actual[i].position.column && expected[i].index == actual[i].index;
+		}
+		if (error_line == 0)
+		{
+			same = same && ps.reported_errors.empty();
+		}
+		else
+		{
+			same = same && ps.reported_errors.size() == 1 && ps.reported_errors[0].position.line == error_line &&
+				   ps.reported_errors[0].position.column == error_column;
+		}
+		if (!same)
+		{
+			printf("Mismatch (%s lexer, seed %lu, iteration %lu) on input:\n", scannerPath(), seed, iteration);
+			printInput(input);
+			return 1;
+		}
+	}
+	printf("%s lexer matches the previous lexer on %lu inputs\n", scannerPath(), iterations);
+	return 0;
+}
@@ -0,0 +1,101 @@
+#include <ProgramStructure.hpp>
+#include <BuiltInGenerators/JsonGenerator.hpp>
+#include <OutputSink.hpp>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <string>
+
+// Runs the JSON generator over a small schema into a MemorySink and checks
+// that every file arrives under the path the generator was given with the
+// contents it rendered, and that a second run replaces rather than adds.
+
+static const char schema[] =
+	"struct Item {\n"
+	"\tstring: name: description(\"Name of the item\");\n"
+	"}\n"
+	"struct Player {\n"
+	"\tstring: name: description(\"Name of the player\");\n"
+	"\tint32: level: description(\"Level of the player\");\n"
+	"}\n";
+
+static int failures = 0;
+
+static void check(bool condition, const std::string &message)
+{
+	if (!condition)
+	{
+		printf("Failed: %s\n", message.c_str());
+		failures++;
+	}
+}
+
+// the schema the generator rendered for struct_name, checked against the source
+static void checkStructFile(const std::map<std::string, std::string> &files, const std::string &struct_name, const std::string &member_name, const std::string &description)
+{
+	std::string path = "out/Json/" + struct_name + ".schema.json";
+	auto it = files.find(path);
+	check(it != files.end(), "no file " + path);
+	if (it == files.end())
+	{
+		return;
+	}
+	nlohmann::json document = nlohmann::json::parse(it->second, nullptr, false);
+	check(!document.is_discarded(), path + " is not JSON");
+	if (document.is_discarded())
+	{
+		return;
+	}
+	check(document.value("title", "") == struct_name, path + " has the wrong title");
+	check(document.contains("properties") && document["properties"].contains(member_name), path + " lacks " + member_name);
+	if (document.contains("properties") && document["properties"].contains(member_name))
+	{
+		check(document["properties"][member_name].value("description", "") == description, path + " has the wrong description for " + member_name);
+	}
+}
+
+int main()
+{
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "schemalang_memory_sink_test";
+	std::filesystem::create_directories(directory);
+	std::string schema_path = (directory / "players.schema").string();
+	{
+		std::ofstream file(schema_path, std::ios::binary);
+		file << schema;
+	}
+
+	ProgramStructure ps;
+	std::string diagnostics;
+	ps.diagnostics = &diagnostics;
+	if (!ps.readFiles({schema_path}, 1))
+	{
+		printf("Failed to read %s:\n%s", schema_path.c_str(), diagnostics.c_str());
+		return 1;
+	}
+
+	JsonGenerator generator;
+	MemorySink sink;
+	for (int run = 1; run <= 2; run++)
+	{
+		check(ps.generate_files(&generator, "out/Json", sink), "generate_files failed in run " + std::to_string(run));
+		OutputTotals totals;
+		check(sink.finish(totals), "finish failed in run " + std::to_string(run));
+		check(totals.written == 2, "run " + std::to_string(run) + " wrote " + std::to_string(totals.written) + " files, expected 2");
+
+		const std::map<std::string, std::string> &files = sink.getFiles();
+		check(files.size() == 2, "the sink holds " + std::to_string(files.size()) + " files, expected 2");
+		checkStructFile(files, "Item", "name", "Name of the item");
+		checkStructFile(files, "Player", "name", "Name of the player");
+		checkStructFile(files, "Player", "level", "Level of the player");
+	}
+
+	std::error_code ec;
+	std::filesystem::remove_all(directory, ec);
+	if (failures != 0)
+	{
+		return 1;
+	}
+	printf("MemorySink holds the generated files\n");
+	return 0;
+}